@@ -0,0 +1,164 @@
+/*
+ * Implementation of the ARC_Evictor declared in arc_evictor.hh.
+ */
+
+#include "arc_evictor.hh"
+#include <algorithm>
+
+template <class Table>
+void
+ARC_Evictor::unlink(Table& table, uint32_t n)
+{
+    auto& node = table[n];
+    Queue& queue = queues_[node.list];
+    if (node.prev == NIL) queue.head = node.next;
+    else table[node.prev].next = node.next;
+    if (node.next == NIL) queue.tail = node.prev;
+    else table[node.next].prev = node.prev;
+    --queue.size;
+}
+
+template <class Table>
+void
+ARC_Evictor::push_back(Table& table, List list, uint32_t n)
+{
+    Queue& queue = queues_[list];
+    auto& node = table[n];
+    node.list = list;
+    node.prev = queue.tail;
+    node.next = NIL;
+    if (queue.tail == NIL) queue.head = n;
+    else table[queue.tail].next = n;
+    queue.tail = n;
+    ++queue.size;
+}
+
+void
+ARC_Evictor::drop_ghost(List list)
+// Forgets the oldest ghost in B1 or B2
+{
+    uint32_t g = queues_[list].head;
+    unlink(ghosts_, g);
+    ghosts_.erase(g);
+}
+
+void
+ARC_Evictor::trim_ghosts()
+// ARC's bounds: T1 and B1 together within the capacity, everything within twice it
+{
+    while (queues_[B1].size > 0 && queues_[T1].size + queues_[B1].size > capacity_) {
+        drop_ghost(B1);
+    }
+    while (queues_[B2].size > 0 && resident_.size() + ghosts_.size() > 2 * capacity_) {
+        drop_ghost(B2);
+    }
+}
+
+void
+ARC_Evictor::touch_key(const key_type& key)
+{
+    std::size_t hash = resident_.hash(key);
+    uint32_t n = resident_.find(key, hash);
+    if (n != NIL) {
+        // Seen again: frequent
+        unlink(resident_, n);
+        push_back(resident_, T2, n);
+        return;
+    }
+
+    List list = T1;
+    uint32_t g = ghosts_.find(hash, hash);
+    if (g != NIL) {
+        // Evicted too early: lean towards the list it was evicted from
+        double b1 = queues_[B1].size, b2 = queues_[B2].size;
+        if (ghosts_[g].list == B1) {
+            target_ = std::min<double>(capacity_, target_ + std::max(1.0, b2 / b1));
+            ++ghost_hits_[0];
+        }
+        else {
+            target_ = std::max(0.0, target_ - std::max(1.0, b1 / b2));
+            ++ghost_hits_[1];
+        }
+        unlink(ghosts_, g);
+        ghosts_.erase(g);
+        list = T2;
+    }
+    push_back(resident_, list, resident_.insert(key, hash));
+    trim_ghosts();
+}
+
+ARC_Evictor::List
+ARC_Evictor::victim_list() const
+// T1 while it is over its target (or T2 is empty), else T2
+{
+    const Queue& t1 = queues_[T1];
+    return (t1.size > 0 && (t1.size > target_ || queues_[T2].size == 0)) ? T1 : T2;
+}
+
+const key_type
+ARC_Evictor::evict()
+{
+    capacity_ = resident_.size();
+    if (capacity_ == 0) {
+        return "";
+    }
+    List from = victim_list();
+    uint32_t n = queues_[from].head;
+    unlink(resident_, n);
+    key_type k = resident_[n].key;
+    std::size_t hash = resident_[n].hash;
+    resident_.erase(n);
+
+    // Two keys with the same hash share a ghost
+    if (ghosts_.find(hash, hash) == NIL) {
+        push_back(ghosts_, from == T1 ? B1 : B2, ghosts_.insert(hash, hash));
+    }
+    trim_ghosts();
+    return k;
+}
+
+const key_type
+ARC_Evictor::peek_victim()
+{
+    if (resident_.size() == 0) {
+        return "";
+    }
+    return resident_[queues_[victim_list()].head].key;
+}
+
+void
+ARC_Evictor::forget_key(const key_type& key)
+// A deleted key leaves no ghost: it wasn't evicted too early
+{
+    uint32_t n = resident_.find(key, resident_.hash(key));
+    if (n != NIL) {
+        unlink(resident_, n);
+        resident_.erase(n);
+    }
+}
+
+void
+ARC_Evictor::clear()
+{
+    resident_.clear();
+    ghosts_.clear();
+    for (Queue& queue : queues_) {
+        queue = Queue();
+    }
+    capacity_ = 0;
+    target_ = 0;
+}
+
+std::map<std::string, double>
+ARC_Evictor::stats() const
+{
+    return {
+        { "arc_target", target_ },
+        { "arc_t1", double(queues_[T1].size) },
+        { "arc_t2", double(queues_[T2].size) },
+        { "arc_b1", double(queues_[B1].size) },
+        { "arc_b2", double(queues_[B2].size) },
+        { "arc_b1_hits", double(ghost_hits_[0]) },
+        { "arc_b2_hits", double(ghost_hits_[1]) },
+    };
+}
@@ -0,0 +1,88 @@
+/*
+ * Declarations for an ARC (Adaptive Replacement Cache) eviction policy according to the pattern in evictor.hh.
+ * Implemented in arc_evictor.cc.
+ *
+ * ARC (Megiddo and Modha, FAST 2003) splits resident keys into T1, seen once
+ * recently, and T2, seen at least twice, each kept in LRU order. Evicted keys
+ * are remembered in ghost lists B1 and B2, according to where they came from.
+ * A miss on a key in B1 means T1 was too small, so the target size for T1
+ * grows; a miss on a key in B2 shrinks it. Eviction takes T1's LRU key while
+ * T1 is over target, T2's otherwise. So the policy drifts towards recency or
+ * frequency as the workload does.
+ *
+ * Ghosts keep only the key's hash, not the key. The evictor doesn't know the
+ * cache's capacity; since the cache only calls evict() when it is full, the
+ * resident count at that point stands in for it. Because the cache evicts
+ * before it touches the new key, the target adapts just after the eviction
+ * it would have steered in the paper.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "evictor.hh"
+#include "key_table.hh"
+
+class ARC_Evictor final : public Evictor {
+private:
+    enum List : uint8_t { T1, T2, B1, B2 };
+
+    struct Node {
+        key_type key;
+        std::size_t hash;
+        uint32_t prev;  // Towards the least recently used end
+        uint32_t next;  // Towards the most recently used end
+        List list;
+    };
+    // A ghost's key is its hash
+    struct Ghost {
+        std::size_t key;
+        std::size_t hash;
+        uint32_t prev;
+        uint32_t next;
+        List list;
+    };
+    static constexpr uint32_t NIL = Key_Table<Node>::NIL;
+
+    struct Queue {
+        uint32_t head = NIL;    // Least recently used
+        uint32_t tail = NIL;    // Most recently used
+        std::size_t size = 0;
+    };
+
+    Key_Table<Node> resident_;
+    Key_Table<Ghost, std::size_t> ghosts_;
+    Queue queues_[4];
+    std::size_t capacity_ = 0;      // Resident keys at the last evict()
+    double target_ = 0;             // Target size of T1 ('p' in the paper)
+    uint64_t ghost_hits_[2] = {};   // Misses found in B1 and B2
+
+    template <class Table> void unlink(Table& table, uint32_t n);
+    template <class Table> void push_back(Table& table, List list, uint32_t n);
+    void drop_ghost(List list);
+    void trim_ghosts();
+    List victim_list() const;
+
+public:
+    ARC_Evictor() = default;
+    ARC_Evictor(const ARC_Evictor&) = delete;
+    ARC_Evictor& operator=(const ARC_Evictor&) = delete;
+
+    void touch_key(const key_type&) override;
+    const key_type evict() override;
+    const key_type peek_victim() override;
+    bool empty() const override { return size() == 0; }
+    uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                         std::vector<key_type>& victims) override {
+        return evict_bytes_of(*this, bytes, size_of, victims);
+    }
+    void forget_key(const key_type&) override;
+    void clear() override;
+
+    // target (p), the sizes of T1, T2, B1 and B2, and ghost hits
+    std::map<std::string, double> stats() const override;
+
+    // Number of resident keys
+    std::size_t size() const { return resident_.size(); }
+    double target() const { return target_; }
+};
@@ -0,0 +1,674 @@
+/*
+ * The cache itself, as a header-only template:
+ *
+ *   BasicCache<Hasher, EvictionPolicy, Storage>
+ *
+ * Hasher: callable taking a std::string_view and returning std::size_t.
+ * EvictionPolicy: anything with Evictor's touch_key_sized()/evict() (see
+ *   "evictor.hh"). When it's a concrete, final class such as LRU_Evictor the
+ *   calls are direct and can be inlined; with Evictor itself they are virtual.
+ * Storage: where value bytes live; Slab_Allocator (see "slab_allocator.hh")
+ *   or anything with the same interface.
+ *
+ * Cache (see "cache.hh") is BasicCache<Function_Hash, Evictor> behind a
+ * pimpl, for callers that pick the hasher and policy at run time. The
+ * operations and their semantics are the same as Cache's, so see there.
+ *
+ * Every key has exactly one record in the index (an Entry), holding its size and
+ * the location of its bytes, so a set/get/del hashes the key once. The index is
+ * an open-addressing Hash_Index (see "hash_index.hh") rather than a chained
+ * std::unordered_map, so a lookup doesn't chase bucket pointers. Value bytes
+ * are not kept in a std::string per entry; they live in chunks handed out by
+ * the Storage.
+ *
+ * Reads through get_shared() don't modify anything, so they can run side by side
+ * under a shared lock. Chunks that a writer unlinks are retired rather than
+ * freed, and only go back to the Storage once no reader can still be copying
+ * them (see "epoch.hh"). Readers don't call the evictor's touch_key() either:
+ * they note the entry in a per-thread buffer (see "touch_buffer.hh") that the
+ * next writer replays into the evictor, or the first reader to find its
+ * buffer full, if no other reader is replaying already. Policies with
+ * concurrent_marks(), such as the CLOCK evictors, are told about the hit right
+ * away through mark_key() instead, so no hit is lost when the buffer
+ * overflows.
+ *
+ * Entries set with a TTL also sit on a timing wheel (see "timing_wheel.hh").
+ * Reads treat an expired entry as missing; writers remove it when they come
+ * across it, and each write also takes a few due entries off the wheel.
+ * expire() does the same in bigger slices, for a background thread.
+ *
+ * A counting Bloom filter of the keys present (see "key_filter.hh") can be
+ * asked through may_contain() without any lock, so callers can answer most
+ * lookups for keys the cache doesn't have before locking anything.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "epoch.hh"
+#include "evictor.hh"
+#include "fast_hash.hh"
+#include "hash_index.hh"
+#include "key_filter.hh"
+#include "slab_allocator.hh"
+#include "timing_wheel.hh"
+#include "touch_buffer.hh"
+#include "value_handle.hh"
+
+template <class Hasher = Fast_Hash, class EvictionPolicy = Evictor, class Storage = Slab_Allocator>
+class BasicCache {
+ public:
+  using byte_type = char;
+  using val_type = const byte_type*;
+  using size_type = uint64_t;
+  using stats_type = std::map<std::string, double>;
+  // Time to live for a set; zero (the default) means until evicted
+  using ttl_type = std::chrono::milliseconds;
+
+  // Everything the cache knows about one key, stored next to the key itself.
+  // 'size' is what the client told us; the chunk at 'data' holds the stored
+  // copy, including its terminating NUL. 'expiry' links the entry into the
+  // timing wheel if it has a TTL (the node it hooks is the index's node_type).
+  struct Entry {
+    size_type size;
+    byte_type* data;
+    Wheel_Hook<std::pair<const key_type, Entry>> expiry;
+  };
+
+  using table_type = Hash_Index<Entry, Hasher>;
+  using node_type = typename table_type::value_type;
+
+  // The timing wheel turns once per TICK, so TTLs are rounded up to it
+  static constexpr ttl_type TICK = ttl_type(10);
+
+  // Entries read by get_shared() since they were last replayed. When a
+  // stripe is full and another reader is already replaying, touches are
+  // dropped, which only costs the evictor some recency information.
+  using touch_buffer_type = Touch_Buffer<node_type>;
+
+  // maxmem, max_load_factor, evictor and count_overhead are as for Cache's
+  // constructor.
+  BasicCache(size_type maxmem,
+             float max_load_factor = 0.75,
+             EvictionPolicy* evictor = nullptr,
+             Hasher hasher = Hasher(),
+             bool count_overhead = false)
+    : m_current_mem(0),
+      m_entries(std::move(hasher), max_load_factor),
+      m_maxmem(maxmem),
+      m_evictor(evictor),
+      m_evictor_marks(evictor != nullptr && evictor->concurrent_marks()),
+      m_evictor_touches(evictor != nullptr && !(m_evictor_marks && evictor->marks_replace_touches())),
+      m_count_overhead(count_overhead),
+      m_filter_owner(new Key_Filter(0)),
+      m_filter(m_filter_owner.get())
+  {
+    // Values whose real size is far above what sets charge for them hit the
+    // page cap before maxmem, and are then evicted by size class (see store())
+    m_slab.set_budget(maxmem);
+  }
+
+  BasicCache(const BasicCache&) = delete;
+  BasicCache& operator=(const BasicCache&) = delete;
+
+  void set(key_type key, val_type val, size_type size, ttl_type ttl = ttl_type::zero()) {
+    assert (val != NULL && "String was null :/ \n");
+    store(std::move(key), val, std::strlen(val), size, ttl);
+  }
+  void set(std::string_view key, std::string_view val, size_type size,
+           ttl_type ttl = ttl_type::zero()) {
+    store(key_type(key), val.data(), val.size(), size, ttl);
+  }
+  void set(key_type&& key, std::string&& val, size_type size, ttl_type ttl = ttl_type::zero()) {
+    store(std::move(key), val.data(), val.size(), size, ttl);
+  }
+
+  // Store 'length' bytes from 'val' under 'key', charging it against maxmem
+  // (see charge()). The bytes may contain NULs; the chunk gets one more as a
+  // terminator so the C-string get() keeps working. A nonzero ttl makes the
+  // entry expire that long from now; zero drops any TTL the key had.
+  void store(key_type&& key, const byte_type* val, std::size_t length, size_type size,
+             ttl_type ttl = ttl_type::zero()) {
+    std::size_t bytes = length + 1;
+    size_type new_charge = charge(key.size(), bytes, size);
+    // If data is larger than cache capacity
+    if (new_charge > m_maxmem || bytes > Storage::MAX_LENGTH) {
+      std::cout << "It don't fit.\n";
+      return;
+    }
+    begin_write();
+
+    std::size_t hash = m_entries.hash(key);
+    node_type* existing = m_entries.find(key, hash);
+    size_type old_charge = (existing == nullptr) ? 0 : charge(*existing);
+
+    // Evict until the new value fits, asking for the whole shortfall at
+    // once. With no eviction policy, reject it.
+    while (m_current_mem - old_charge + new_charge > m_maxmem) {
+      if (m_evictor == nullptr) {
+        return;
+      }
+      if (!evict_batch(m_current_mem - old_charge + new_charge - m_maxmem, existing,
+                       m_evictions)) {
+        return;   // Evictor has nothing left to offer
+      }
+      if (existing == nullptr) {
+        old_charge = 0;
+      }
+    }
+
+    bool added = existing == nullptr;
+    if (added) {
+      m_key_bytes += key.size();
+      existing = m_entries.insert(std::move(key), Entry{ size, nullptr, {} }, hash);
+      filter_add(hash);
+    }
+    else {
+      retire(existing->second.data);
+    }
+    // The storage's owner cookie points back at the index node, which never moves
+    byte_type* data = m_slab.allocate(bytes, existing);
+    while (data == nullptr) {
+      // Out of slab pages: like memcached, free the least recently used value
+      // of this size class. Its chunk only comes back once no reader can be
+      // copying it, so one a reader holds doesn't help.
+      auto owner = static_cast<node_type*>(m_slab.lru_victim(bytes));
+      if (owner == nullptr) {
+        forget(existing->first);
+        if (existing->second.expiry.deadline != 0) {
+          m_wheel.cancel(*existing);
+        }
+        m_current_mem -= old_charge;
+        m_key_bytes -= existing->first.size();
+        m_filter_owner->remove(hash);
+        m_entries.erase(existing);
+        return;
+      }
+      ++m_slab_evictions;
+      forget(owner->first);
+      erase(owner);
+      reclaim();
+      data = m_slab.allocate(bytes, existing);
+    }
+    std::memcpy(data, val, length);
+    data[length] = '\0';
+    existing->second.size = size;
+    existing->second.data = data;
+    m_current_mem = m_current_mem - old_charge + new_charge;
+    if (existing->second.expiry.deadline != 0) {
+      m_wheel.cancel(*existing);
+    }
+    if (ttl > ttl_type::zero()) {
+      // Rounded up a tick further, since the current one is partly gone
+      m_wheel.schedule(*existing, now_ticks() + (ttl + TICK - ttl_type(1)) / TICK + 1);
+    }
+
+    // Let the eviction policy know about the new item
+    if (m_evictor != nullptr) {
+      if (added) {
+        m_evictor->insert_key(existing->first, charge(*existing), 1.0);
+      }
+      else {
+        touch_evictor(*existing);
+      }
+    }
+  }
+
+  val_type get(const key_type& key, size_type& val_size) {
+    node_type* entry = m_entries.find(key);
+    if (entry == nullptr) {
+        return nullptr;
+    }
+    if (expired(*entry)) {
+      drain_touches();   // They may still point at the entry
+      expire_entry(*entry);
+      return nullptr;
+    }
+    if (m_evictor != nullptr) {
+        touch_evictor(*entry);
+    }
+    m_slab.touch(entry->second.data);
+    get_val_.assign(entry->second.data, m_slab.length(entry->second.data) - 1);
+    val_size = entry->second.size;
+    return static_cast<val_type>(get_val_.c_str());
+  }
+
+  val_type get_shared(const key_type& key, size_type& val_size) const {
+    const node_type* entry = m_entries.find(key);
+    if (entry == nullptr || expired(*entry)) {
+      return nullptr;
+    }
+    note_touch(*entry);
+    val_size = entry->second.size;
+    return entry->second.data;
+  }
+
+  Value_Handle get(std::string_view key) const {
+    const node_type* entry = m_entries.find(key);
+    if (entry == nullptr || expired(*entry)) {
+      return Value_Handle();
+    }
+    note_touch(*entry);
+    const byte_type* data = entry->second.data;
+    std::size_t length = m_slab.length(data) - 1;
+    if (Storage::pin(data)) {
+      return Value_Handle(data, length, entry->second.size, &Storage::unpin);
+    }
+    // Pin count saturated: fall back to a private copy
+    byte_type* copy = new byte_type[length + 1];
+    std::memcpy(copy, data, length + 1);
+    return Value_Handle(copy, length, entry->second.size,
+                        [](const byte_type* p) { delete[] p; });
+  }
+
+  std::size_t stored_length(val_type val) const {
+    // get() hands out its private copy, get_shared() the chunk itself
+    if (val == get_val_.c_str()) {
+      return get_val_.size();
+    }
+    return m_slab.length(val) - 1;
+  }
+
+  bool del(std::string_view key) {
+    begin_write();
+    node_type* entry = m_entries.find(key);
+    if (entry == nullptr) {
+      return false;
+    }
+    if (expired(*entry)) {
+      expire_entry(*entry);
+      return false;
+    }
+    forget(entry->first);
+    erase(entry);
+    return true;
+  }
+
+  // Entries set with a TTL that haven't expired or been removed yet
+  std::size_t ttl_entries() const {
+    return m_wheel.size();
+  }
+
+  // Remove up to 'budget' entries whose TTL has run out, oldest deadline
+  // first. Returns how many; if that's 'budget' there may be more.
+  std::size_t expire(std::size_t budget) {
+    drain_touches();
+    std::size_t expired = expire_due(budget);
+    reclaim();
+    return expired;
+  }
+
+  // Evict until no more than 'target' is charged against maxmem, the way a
+  // set that doesn't fit would. Meant for a background thread to run ahead of
+  // the sets (see ShardedCache::start_maintenance()). Returns the number of
+  // bytes freed, which falls short if the evictor runs out of keys.
+  size_type evict_to(size_type target) {
+    if (m_evictor == nullptr || m_current_mem <= target) {
+      return 0;
+    }
+    begin_write();
+    size_type before = m_current_mem;
+    node_type* none = nullptr;
+    while (m_current_mem > target) {
+      if (!evict_batch(m_current_mem - target, none, m_evictions_ahead)) {
+        break;
+      }
+    }
+    m_bytes_evicted_ahead += before - m_current_mem;
+    return before - m_current_mem;
+  }
+
+  // Total charged against maxmem (see charge())
+  size_type space_used() const {
+    return m_current_mem;
+  }
+
+  // Approximate real footprint: slab pages, key strings, one index node per
+  // entry, the index's slot table and the key filter.
+  std::size_t memory_used() const {
+    return m_slab.reserved() + m_key_bytes +
+           m_entries.size() * sizeof(node_type) +
+           m_entries.table_bytes() + m_filter_owner->memory_bytes();
+  }
+
+  stats_type stats() const {
+    stats_type result;
+    result["entries"] = m_entries.size();
+    result["index_slots"] = m_entries.capacity();
+    result["index_rehashes"] = m_entries.rehashes();
+    result["index_rehash_pending"] = m_entries.rehash_pending();
+    result["space_used"] = m_current_mem;
+    result["maxmem"] = m_maxmem;
+    result["count_overhead"] = m_count_overhead;
+    result["memory_used"] = memory_used();
+    result["filter_bytes"] = m_filter_owner->memory_bytes();
+    result["retired_chunks"] = m_retired.size();
+    result["touches_dropped"] = m_touches_dropped.load(std::memory_order_relaxed);
+    result["reader_drains"] = m_reader_drains.load(std::memory_order_relaxed);
+    result["evictions"] = m_evictions;
+    result["evictions_ahead"] = m_evictions_ahead;
+    result["bytes_evicted_ahead"] = m_bytes_evicted_ahead;
+    result["slab_evictions"] = m_slab_evictions;
+    result["ttl_entries"] = m_wheel.size();
+    result["expirations"] = m_expirations;
+    // A reader may be replaying touches into the evictor and the slab
+    std::lock_guard<std::mutex> drain_guard(m_drain_mutex);
+    if (m_evictor != nullptr) {
+      for (const auto& stat : m_evictor->stats()) {
+        result["evictor." + stat.first] = stat.second;
+      }
+    }
+    auto classes = m_slab.stats();
+    for (std::size_t i = 0; i < classes.size(); ++i) {
+      const auto& cls = classes[i];
+      if (cls.total_chunks == 0) {
+        continue;
+      }
+      std::string prefix = "slab." + std::to_string(i) + ".";
+      result[prefix + "chunk_size"] = cls.chunk_size;
+      result[prefix + "pages"] = cls.pages;
+      result[prefix + "used_chunks"] = cls.used_chunks;
+      result[prefix + "total_chunks"] = cls.total_chunks;
+      result[prefix + "requested_bytes"] = cls.requested_bytes;
+      result[prefix + "occupancy"] = cls.occupancy();
+      result[prefix + "fragmentation"] = cls.fragmentation();
+    }
+    return result;
+  }
+
+  // False if key is certainly not in the cache; true if it may be. Needs no
+  // lock, and may run alongside anything, but the caller must hold an
+  // Epoch_Guard (see "epoch.hh"). A key being set or deleted meanwhile may
+  // be reported either way.
+  bool may_contain(std::string_view key) const {
+    return m_filter.load(std::memory_order_acquire)->may_contain(m_entries.hash(key));
+  }
+
+  // Whether a Value_Handle still refers to any of the cache's chunks, live
+  // or retired. Takes time in proportion to the entries: it's meant for
+  // deciding when a cache nobody uses any more may be destroyed.
+  bool pinned() const {
+    bool found = false;
+    m_entries.for_each([this, &found](const node_type& entry) {
+      found = found || m_slab.pinned(entry.second.data);
+    });
+    for (const auto& retired : m_retired) {
+      found = found || m_slab.pinned(retired.second);
+    }
+    return found;
+  }
+
+  // Never waits for pinned readers, which may themselves be waiting on a lock
+  // the caller holds: like any other write, it retires the values' chunks,
+  // and only those no reader can still be copying go back to the slab now.
+  void reset() {
+    m_touches.clear();
+    m_wheel.clear();
+    m_entries.for_each([this](node_type& entry) { retire(entry.second.data); });
+    m_current_mem = 0;
+    m_key_bytes = 0;
+    m_entries.clear();
+    m_filter_owner->clear();
+    if (m_evictor != nullptr) {
+      m_evictor->clear();
+    }
+    reclaim();
+    // Chunks held by a Value_Handle keep their pages alive a little longer
+    if (m_retired.empty()) {
+      m_slab.clear();
+    }
+  }
+
+ private:
+  // Queue a hit for the evictor and the storage's LRU, to be replayed by the
+  // next writer. A marking evictor gets it right away.
+  //
+  // A reader that finds its buffer full replays everything itself, still
+  // under the shared lock. That is safe because readers never look at the
+  // evictor or the slab's LRU order, and replaying readers take turns on
+  // m_drain_mutex; one that finds the mutex taken drops its touch instead
+  // of waiting.
+  void note_touch(const node_type& entry) const {
+    if (m_evictor_marks) {
+      m_evictor->mark_key(entry.first);
+    }
+    node_type* node = const_cast<node_type*>(&entry);
+    if (m_touches.offer(node)) {
+      return;
+    }
+    if (m_drain_mutex.try_lock()) {
+      const_cast<BasicCache*>(this)->drain_touches();
+      m_drain_mutex.unlock();
+      m_reader_drains.fetch_add(1, std::memory_order_relaxed);
+      if (m_touches.offer(node)) {
+        return;
+      }
+    }
+    m_touches_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Replay buffered hits. Nothing is erased while readers run, and writers
+  // drain before erasing anything, so every buffered node is still live.
+  void drain_touches() {
+    m_touches.drain([this](node_type* node) {
+      if (m_evictor_touches) {
+        touch_evictor(*node);
+      }
+      m_slab.touch(node->second.data);
+    });
+  }
+
+  // Called at the start of every operation that modifies the cache, while
+  // the caller holds it exclusively, so no reader is replaying meanwhile.
+  void begin_write() {
+    drain_touches();
+    expire_due(EXPIRE_PER_WRITE);
+    reclaim();
+  }
+
+  // Due entries each write takes off the timing wheel, so they go even
+  // without a background thread calling expire()
+  static constexpr std::size_t EXPIRE_PER_WRITE = 4;
+
+  // Ticks of the timing wheel since the cache was made
+  uint64_t now_ticks() const {
+    return (std::chrono::steady_clock::now() - m_start) / TICK;
+  }
+
+  // Whether entry's TTL has run out. Reads the clock only for entries with one.
+  bool expired(const node_type& entry) const {
+    uint64_t deadline = entry.second.expiry.deadline;
+    return deadline != 0 && deadline <= now_ticks();
+  }
+
+  // Remove up to 'budget' expired entries from the wheel
+  std::size_t expire_due(std::size_t budget) {
+    if (m_wheel.size() == 0) {
+      return 0;
+    }
+    return m_wheel.advance(now_ticks(), budget, [this](node_type& entry) {
+      // Already off the wheel
+      ++m_expirations;
+      forget(entry.first);
+      erase(&entry);
+    });
+  }
+
+  // Remove one expired entry found by a lookup
+  void expire_entry(node_type& entry) {
+    ++m_expirations;
+    forget(entry.first);
+    erase(&entry);
+  }
+
+  // Tell the evictor about an overwrite or hit, with what the entry costs in maxmem.
+  // The cache doesn't know what misses cost the client, so all weigh the same.
+  void touch_evictor(const node_type& entry) {
+    m_evictor->touch_key_sized(entry.first, charge(entry), 1.0);
+  }
+
+  // The evictor only hears about evict()'s own victims otherwise
+  void forget(const key_type& key) {
+    if (m_evictor != nullptr) {
+      m_evictor->forget_key(key);
+    }
+  }
+
+  // Unlinked chunk: keep its bytes intact until no reader can be copying them
+  // and no Value_Handle refers to them.
+  void retire(byte_type* data) {
+    m_slab.detach(data);
+    m_retired.emplace_back(Epoch_Manager::global().retire_epoch(), data);
+  }
+
+  // Count a new key in the filter. One that has outgrown its size is
+  // replaced with one four times bigger, filled from the index; the old one
+  // is retired like a chunk, since readers may be looking at it.
+  void filter_add(std::size_t hash) {
+    if (m_entries.size() <= m_filter_owner->capacity()) {
+      m_filter_owner->add(hash);
+      return;
+    }
+    std::unique_ptr<Key_Filter> bigger(new Key_Filter(m_entries.size() * 4));
+    m_entries.for_each([this, &bigger](const node_type& entry) {
+      bigger->add(m_entries.hash(entry.first));
+    });
+    m_filter.store(bigger.get(), std::memory_order_release);
+    std::swap(bigger, m_filter_owner);
+    m_retired_filters.emplace_back(Epoch_Manager::global().retire_epoch(), std::move(bigger));
+  }
+
+  void reclaim() {
+    auto& filters = m_retired_filters;
+    while (!filters.empty() && Epoch_Manager::global().is_safe(filters.front().first)) {
+      filters.erase(filters.begin());
+    }
+    if (m_retired.empty()) {
+      return;
+    }
+    // Stamps are increasing, so everything after the first unsafe one is
+    // unsafe too. Pinned chunks are skipped and stay on the list.
+    auto& epochs = Epoch_Manager::global();
+    std::size_t kept = 0, i = 0;
+    for (; i < m_retired.size() && epochs.is_safe(m_retired[i].first); ++i) {
+      if (m_slab.pinned(m_retired[i].second)) {
+        m_retired[kept++] = m_retired[i];
+      }
+      else {
+        m_slab.release(m_retired[i].second);
+      }
+    }
+    m_retired.erase(std::move(m_retired.begin() + i, m_retired.end(), m_retired.begin() + kept),
+                    m_retired.end());
+  }
+
+  // What an entry costs against maxmem. By default that's the size the
+  // client gave. With count_overhead it's measured instead: the value's
+  // chunk as the storage lays it out, the key, the index node and the
+  // entry's share of the index table, which is what memory_used() adds up.
+  size_type charge(std::size_t key_length, std::size_t bytes, size_type size) const {
+    if (!m_count_overhead) {
+      return size;
+    }
+    return m_slab.footprint(bytes) + key_length + sizeof(node_type) + m_entries.slot_bytes();
+  }
+  size_type charge(const node_type& entry) const {
+    return charge(entry.first.size(), m_slab.length(entry.second.data), entry.second.size);
+  }
+
+  // Ask the evictor for at least 'bytes' worth of victims and erase them,
+  // adding to 'evictions' the number that were still present. Returns false
+  // once it has none left. 'existing' is set to nullptr if it was among them.
+  bool evict_batch(size_type bytes, node_type*& existing, uint64_t& evictions) {
+    m_victims.clear();
+    m_victim_nodes.clear();
+    m_evictor->evict_bytes(bytes,
+                           [this](const key_type& victim) -> uint64_t {
+                             node_type* entry = m_entries.find(victim);
+                             if (entry == nullptr) {
+                               return 0;
+                             }
+                             m_victim_nodes.push_back(entry);
+                             return charge(*entry);
+                           },
+                           m_victims);
+    // An evictor that hands out a key twice mustn't get its entry erased twice
+    std::sort(m_victim_nodes.begin(), m_victim_nodes.end());
+    m_victim_nodes.erase(std::unique(m_victim_nodes.begin(), m_victim_nodes.end()),
+                         m_victim_nodes.end());
+    for (node_type* victim : m_victim_nodes) {
+      if (victim == existing) {
+        existing = nullptr;
+      }
+      erase(victim);
+    }
+    evictions += m_victim_nodes.size();
+    return !m_victims.empty();
+  }
+
+  void erase(node_type* entry) {
+    if (entry->second.expiry.deadline != 0) {
+      m_wheel.cancel(*entry);
+    }
+    m_current_mem -= charge(*entry);
+    m_key_bytes -= entry->first.size();
+    m_filter_owner->remove(m_entries.hash(entry->first));
+    retire(entry->second.data);
+    m_entries.erase(entry);
+  }
+
+  size_type m_current_mem;
+  table_type m_entries;
+  Storage m_slab;
+  std::size_t m_key_bytes = 0;
+  std::string get_val_;
+
+  // Unlinked chunks waiting for readers to move on, with their retire stamp
+  std::vector<std::pair<uint64_t, byte_type*>> m_retired;
+
+  mutable touch_buffer_type m_touches;
+  mutable std::mutex m_drain_mutex;
+  mutable std::atomic<uint64_t> m_touches_dropped{0};
+  mutable std::atomic<uint64_t> m_reader_drains{0};
+
+  // Scratch space for evict_bytes(), kept to save allocating on every eviction
+  std::vector<key_type> m_victims;
+  std::vector<node_type*> m_victim_nodes;
+
+  // Keys evicted by sets that didn't fit, and by evict_to() ahead of them
+  uint64_t m_evictions = 0;
+  uint64_t m_evictions_ahead = 0;
+  size_type m_bytes_evicted_ahead = 0;
+  // Values the slab's page cap pushed out
+  uint64_t m_slab_evictions = 0;
+
+  struct Expiry_Of {
+    Wheel_Hook<node_type>& operator()(node_type& entry) const { return entry.second.expiry; }
+  };
+  Timing_Wheel<node_type, Expiry_Of> m_wheel;
+  std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+  uint64_t m_expirations = 0;
+
+  size_type m_maxmem;
+  EvictionPolicy* m_evictor = nullptr;
+  bool m_evictor_marks;   // Readers mark hits in the evictor themselves
+  bool m_evictor_touches; // Buffered hits are replayed into the evictor
+  bool m_count_overhead;
+
+  // The key filter, and the pointer lock-free readers load it through
+  std::unique_ptr<Key_Filter> m_filter_owner;
+  std::atomic<const Key_Filter*> m_filter;
+  std::vector<std::pair<uint64_t, std::unique_ptr<Key_Filter>>> m_retired_filters;
+};
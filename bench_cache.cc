@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "cache.hh"
+#include "basic_cache.hh"
+#include "lru_evictor.hh"
+
+/*
+  Microbenchmark for the cache's own per-operation overhead: Cache (pimpl,
+  std::function hasher, virtual Evictor) against BasicCache with the hasher
+  and eviction policy fixed at compile time.
+
+  Usage: ./bench_cache [keys] [rounds]   (defaults to 100000 and 20)
+  Each round of each configuration sets every key, then looks every key up
+  in random order, with get() and with the handle get(). The fastest round is
+  reported, in nanoseconds per operation. maxmem is big enough that nothing
+  is evicted, so the evictor only sees touches.
+*/
+
+using Clock = std::chrono::steady_clock;
+
+double ns_per_op(Clock::time_point start, std::size_t ops)
+{
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / ops;
+}
+
+// Keeps the optimizer from dropping lookups whose results aren't used
+volatile std::size_t sink;
+
+// Works on Cache and on any BasicCache, since they share an interface.
+// Every number is the fastest of 'rounds' passes, to keep noise from other
+// processes out of it.
+template <class Cache_Type>
+void bench(const char* name, Cache_Type& cache,
+           const std::vector<key_type>& keys, const std::vector<key_type>& order,
+           std::size_t rounds)
+{
+    const std::string value(32, 'v');
+    double set_ns = 1e9, get_ns = 1e9, handle_ns = 1e9;
+    std::size_t found = 0;
+    Cache::size_type size;
+    for (std::size_t round = 0; round < rounds; ++round) {
+        cache.reset();
+        auto start = Clock::now();
+        for (const auto& key : keys) {
+            cache.set(key, value.c_str(), value.size() + 1);
+        }
+        set_ns = std::min(set_ns, ns_per_op(start, keys.size()));
+
+        start = Clock::now();
+        for (const auto& key : order) {
+            found += cache.get(key, size) != nullptr;
+        }
+        get_ns = std::min(get_ns, ns_per_op(start, order.size()));
+
+        start = Clock::now();
+        for (const auto& key : order) {
+            found += bool(cache.get(std::string_view(key)));
+        }
+        handle_ns = std::min(handle_ns, ns_per_op(start, order.size()));
+    }
+    sink = found;
+
+    std::cout << "  " << name << "  set: " << set_ns << "  get: " << get_ns
+              << "  get handle: " << handle_ns << " ns/op\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    std::size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+    Cache::size_type maxmem = 4 * 1024 * 1024 * 1024U - 1;
+
+    std::vector<key_type> keys;
+    for (std::size_t i = 0; i < count; ++i) {
+        keys.push_back("key:" + std::to_string(i));
+    }
+    std::vector<key_type> order(keys);
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(389));
+
+    std::cout << count << " keys, best of " << rounds << " rounds:\n";
+    {
+        LRU_Evictor evictor;
+        Cache cache(maxmem, 0.75, &evictor, std::hash<key_type>());
+        bench("Cache, std::hash, virtual LRU    ", cache, keys, order, rounds);
+    }
+    {
+        LRU_Evictor evictor;
+        Cache cache(maxmem, 0.75, &evictor);
+        bench("Cache, Fast_Hash, virtual LRU    ", cache, keys, order, rounds);
+    }
+    {
+        LRU_Evictor evictor;
+        BasicCache<Fast_Hash, LRU_Evictor> cache(maxmem, 0.75, &evictor);
+        bench("BasicCache<Fast_Hash, LRU>       ", cache, keys, order, rounds);
+    }
+    {
+        Cache cache(maxmem);
+        bench("Cache, Fast_Hash, no evictor     ", cache, keys, order, rounds);
+    }
+    {
+        BasicCache<Fast_Hash> cache(maxmem);
+        bench("BasicCache<Fast_Hash>, no evictor", cache, keys, order, rounds);
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "arc_evictor.hh"
+#include "clock_evictor.hh"
+#include "clock_pro_evictor.hh"
+#include "fifo_evictor.hh"
+#include "gdsf_evictor.hh"
+#include "lfu_evictor.hh"
+#include "lru_evictor.hh"
+#include "sampled_lru_evictor.hh"
+#include "s3fifo_evictor.hh"
+#include "slru_evictor.hh"
+
+/*
+  Microbenchmark for the evictors on their own, without a cache around them.
+
+  Usage: ./bench_evictor [keys] [rounds]   (defaults to 1000000 and 5)
+  Each round touches every key once (inserts), touches them all again in
+  random order (hits), then evicts one key and touches a new one 'keys'
+  times (churn, what a full cache does on every set), and finally evicts
+  everything. For evictors with concurrent_marks(), hits through mark_key()
+  are timed too. The fastest round is reported, in nanoseconds per operation.
+*/
+
+using Clock = std::chrono::steady_clock;
+
+double ns_per_op(Clock::time_point start, std::size_t ops)
+{
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / ops;
+}
+
+// Keeps the optimizer from dropping evictions whose results aren't used
+volatile std::size_t sink;
+
+template <class Evictor_Type>
+void bench(const char* name, const std::vector<key_type>& keys,
+           const std::vector<key_type>& order, const std::vector<key_type>& fresh,
+           std::size_t rounds)
+{
+    std::size_t count = keys.size();
+    double insert_ns = 1e9, hit_ns = 1e9, mark_ns = 1e9, churn_ns = 1e9, evict_ns = 1e9;
+    std::size_t evicted = 0;
+    for (std::size_t round = 0; round < rounds; ++round) {
+        Evictor_Type evictor;
+        auto start = Clock::now();
+        for (const auto& key : keys) {
+            evictor.touch_key(key);
+        }
+        insert_ns = std::min(insert_ns, ns_per_op(start, keys.size()));
+
+        start = Clock::now();
+        for (const auto& key : order) {
+            evictor.touch_key(key);
+        }
+        hit_ns = std::min(hit_ns, ns_per_op(start, order.size()));
+
+        if (evictor.concurrent_marks()) {
+            start = Clock::now();
+            for (const auto& key : order) {
+                evictor.mark_key(key);
+            }
+            mark_ns = std::min(mark_ns, ns_per_op(start, order.size()));
+        }
+
+        start = Clock::now();
+        for (const auto& key : fresh) {
+            evicted += evictor.evict().size();
+            evictor.touch_key(key);
+        }
+        churn_ns = std::min(churn_ns, ns_per_op(start, fresh.size()));
+
+        start = Clock::now();
+        for (std::size_t i = 0; i < count; ++i) {
+            evicted += evictor.evict().size();
+        }
+        evict_ns = std::min(evict_ns, ns_per_op(start, count));
+    }
+    sink = evicted;
+
+    std::cout << "  " << name << "  insert: " << insert_ns << "  hit: " << hit_ns;
+    if (mark_ns < 1e9) {
+        std::cout << "  mark: " << mark_ns;
+    }
+    std::cout << "  evict+insert: " << churn_ns << "  evict: " << evict_ns << " ns/op\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+    std::vector<key_type> keys, fresh;
+    for (std::size_t i = 0; i < count; ++i) {
+        keys.push_back("key:" + std::to_string(i));
+        fresh.push_back("new:" + std::to_string(i));
+    }
+    std::vector<key_type> order(keys);
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(389));
+
+    std::cout << count << " keys, best of " << rounds << " rounds:\n";
+    bench<LRU_Evictor>("LRU      ", keys, order, fresh, rounds);
+    bench<Sampled_LRU_Evictor>("Sampled  ", keys, order, fresh, rounds);
+    bench<SLRU_Evictor>("SLRU     ", keys, order, fresh, rounds);
+    bench<ARC_Evictor>("ARC      ", keys, order, fresh, rounds);
+    bench<Clock_Evictor>("CLOCK    ", keys, order, fresh, rounds);
+    bench<Clock_Pro_Evictor>("CLOCK-Pro", keys, order, fresh, rounds);
+    bench<FIFO_Evictor>("FIFO     ", keys, order, fresh, rounds);
+    bench<S3FIFO_Evictor>("S3-FIFO  ", keys, order, fresh, rounds);
+    bench<LFU_Evictor>("LFU      ", keys, order, fresh, rounds);
+    bench<GDSF_Evictor>("GDSF     ", keys, order, fresh, rounds);
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "hash_index.hh"
+
+/*
+  Microbenchmark for the cache's key index: Hash_Index against the
+  std::unordered_map (hashing through a std::function) that it replaced.
+
+  Usage: ./bench_index [key counts...]   (defaults to 1000000 10000000)
+  Each count times inserts, hits in random order, misses, and erases, and
+  reports nanoseconds per operation. The slowest single insert is reported
+  too, since that is where a table resize shows up.
+*/
+
+// Same shape as Cache::Impl::Entry
+struct Record {
+    uint32_t size;
+    char* data;
+};
+
+using hash_func = std::function<std::size_t(key_type)>;
+using Clock = std::chrono::steady_clock;
+
+double ns_per_op(Clock::time_point start, std::size_t ops)
+{
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / ops;
+}
+
+void report(const char* name, const char* op, double ns)
+{
+    std::cout << "  " << name << " " << op << ": " << ns << " ns/op\n";
+}
+
+// Runs insert(key) for every key, timing each call, and reports the mean
+// and the worst one.
+template <class Insert>
+void time_inserts(const char* name, const std::vector<key_type>& keys, Insert insert)
+{
+    double worst = 0;
+    auto start = Clock::now();
+    for (const auto& key : keys) {
+        auto before = Clock::now();
+        insert(key);
+        std::chrono::duration<double, std::micro> took = Clock::now() - before;
+        worst = std::max(worst, took.count());
+    }
+    report(name, "insert", ns_per_op(start, keys.size()));
+    std::cout << "  " << name << " slowest insert: " << worst << " us\n";
+}
+
+// Hand the last run's freed memory back to the system now. Otherwise glibc
+// does it during some unlucky free() in the next run, and that shows up as
+// the next run's slowest insert.
+void release_freed_memory()
+{
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+}
+
+// Keeps the optimizer from dropping lookups whose results aren't used
+volatile std::size_t sink;
+
+void bench_unordered_map(const std::vector<key_type>& keys,
+                         const std::vector<key_type>& order,
+                         const std::vector<key_type>& misses)
+{
+    std::unordered_map<key_type, Record, hash_func> map(0, std::hash<key_type>());
+    map.max_load_factor(0.75);
+
+    time_inserts("unordered_map", keys, [&](const key_type& key) {
+        map.emplace(key, Record{ 1, nullptr });
+    });
+
+    std::size_t found = 0;
+    auto start = Clock::now();
+    for (const auto& key : order) {
+        found += map.find(key) != map.end();
+    }
+    report("unordered_map", "hit   ", ns_per_op(start, order.size()));
+
+    start = Clock::now();
+    for (const auto& key : misses) {
+        found += map.find(key) != map.end();
+    }
+    report("unordered_map", "miss  ", ns_per_op(start, misses.size()));
+
+    start = Clock::now();
+    for (const auto& key : order) {
+        map.erase(key);
+    }
+    report("unordered_map", "erase ", ns_per_op(start, order.size()));
+    sink = found;
+}
+
+void bench_hash_index(const std::vector<key_type>& keys,
+                      const std::vector<key_type>& order,
+                      const std::vector<key_type>& misses)
+{
+    // std::hash gives a string_view the same hash as the equal std::string
+    Hash_Index<Record, std::hash<std::string_view>> index(std::hash<std::string_view>(), 0.75);
+
+    time_inserts("Hash_Index   ", keys, [&](const key_type& key) {
+        index.insert(key_type(key), Record{ 1, nullptr });
+    });
+
+    std::size_t found = 0;
+    auto start = Clock::now();
+    for (const auto& key : order) {
+        found += index.find(key) != nullptr;
+    }
+    report("Hash_Index   ", "hit   ", ns_per_op(start, order.size()));
+
+    start = Clock::now();
+    for (const auto& key : misses) {
+        found += index.find(key) != nullptr;
+    }
+    report("Hash_Index   ", "miss  ", ns_per_op(start, misses.size()));
+
+    start = Clock::now();
+    for (const auto& key : order) {
+        index.erase(index.find(key));
+    }
+    report("Hash_Index   ", "erase ", ns_per_op(start, order.size()));
+    sink = found;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::size_t> counts;
+    for (int i = 1; i < argc; ++i) {
+        counts.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+    if (counts.empty()) {
+        counts = { 1000000, 10000000 };
+    }
+
+    std::mt19937_64 rng(389);
+    for (std::size_t count : counts) {
+        std::cout << count << " keys:\n";
+        std::vector<key_type> keys, misses;
+        keys.reserve(count);
+        misses.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            keys.push_back("key:" + std::to_string(i));
+            misses.push_back("nokey:" + std::to_string(i));
+        }
+        std::vector<key_type> order(keys);
+        std::shuffle(order.begin(), order.end(), rng);
+
+        bench_unordered_map(keys, order, misses);
+        release_freed_memory();
+        bench_hash_index(keys, order, misses);
+        release_freed_memory();
+    }
+    return 0;
+}
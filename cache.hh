@@ -1,14 +1,25 @@
 /*
  * Interface for a generic cache object.
  * Data is given as blobs (void *) of a given size, and indexed by a string key.
+ *
+ * The library implementation (cache_lib.cc) only forwards, type-erased, to
+ * BasicCache (see "basic_cache.hh"), which owns the index, value storage and
+ * eviction. Code that knows its hasher and eviction policy at compile time can
+ * use BasicCache directly and skip the indirection.
  */
 
 #pragma once
 
+#include <chrono>
 #include <functional>
+#include <map>
 #include <memory>
+#include <string>
+#include <string_view>
 
 #include "evictor.hh"
+#include "fast_hash.hh"
+#include "value_handle.hh"
 
 class Cache {
  private:
@@ -20,11 +31,17 @@ class Cache {
  public:
   using byte_type = char;
   using val_type = const byte_type*;   // Values for K-V pairs
-  using size_type = uint32_t;         // Internal indexing to K-V elements
+  using size_type = uint64_t;         // Sizes and capacities, in bytes
+  using stats_type = std::map<std::string, double>;  // Named counters from stats()
+  using ttl_type = std::chrono::milliseconds;         // Time to live, zero for none
 
   // A function that takes a key and returns an index to the internal data
   using hash_func = std::function<std::size_t(key_type)>;
 
+  // A reference to a value stored in the cache, returned by get(key).
+  // See "value_handle.hh".
+  using Value_Handle = ::Value_Handle;
+
   // There are two possible constructors, one for a cache object (library),
   // that initializes the actual cache store, and another for a client
   // that simply accesses the Cache store over the network. The two
@@ -36,11 +53,18 @@ class Cache {
   // max_load_factor: Maximum allowed ratio between buckets and table rows.
   // evictor: Eviction policy implementation (if nullptr, no evictions occur
   // and new insertions fail after maxmem has been exceeded).
-  // hasher: Hash function to use on the keys. Defaults to C++'s std::hash.
+  // hasher: Hash function to use on the keys. Defaults to Fast_Hash (see
+  // "fast_hash.hh"), which is then called directly rather than through the
+  // std::function.
+  // count_overhead: If false, each value is charged the size passed to set().
+  // If true, it's charged what it really occupies: its storage chunk, its key
+  // and its share of the index, so maxmem bounds memory_used() rather than
+  // just the value bytes.
   Cache(size_type maxmem,
         float max_load_factor = 0.75,
         Evictor* evictor = nullptr,
-        hash_func hasher = std::hash<key_type>());
+        hash_func hasher = Fast_Hash(),
+        bool count_overhead = false);
 
   // Create a new Cache networked client with a given host and port.
   Cache(std::string host, std::string port);
@@ -57,20 +81,85 @@ class Cache {
   // If maxmem capacity is exceeded, enough values will be removed
   // from the cache to accomodate the new value. If unable, the new value
   // isn't inserted to the cache.
-  void set(key_type key, val_type val, size_type size);
+  // With a nonzero ttl the value expires that long after the set (rounded up
+  // to the next 10 ms): gets miss it, and its space is reclaimed when it's next
+  // looked up, by later sets, or by expire(). A set without one clears any
+  // TTL the key had.
+  // val must be a NUL-terminated C string; what's stored ends at its first
+  // NUL whatever size says, since size is only the charge. Binary values go
+  // through the string_view overload below.
+  void set(key_type key, val_type val, size_type size, ttl_type ttl = ttl_type::zero());
+
+  // Binary-safe set: stores exactly the bytes in val, NULs included, and
+  // charges size against maxmem as above.
+  void set(std::string_view key, std::string_view val, size_type size,
+           ttl_type ttl = ttl_type::zero());
+
+  // Same, but takes over the caller's key string instead of copying it.
+  void set(key_type&& key, std::string&& val, size_type size, ttl_type ttl = ttl_type::zero());
 
   // Retrieve a pointer to the value associated with key in the cache,
   // or nullptr if not found.
   // Sets the actual size of the returned value (in bytes) in val_size.
   val_type get(key_type key, size_type& val_size) const;
 
+  // Retrieve a handle to the value associated with key, without copying it.
+  // The handle is empty if key isn't found. Like get_shared(), this doesn't
+  // modify the cache, so it may run concurrently with other reads. Binary
+  // values come back whole: use the handle's length(), not strlen().
+  Value_Handle get(std::string_view key) const;
+
+  // Concurrent read path. Like get(), but never modifies the cache, so any
+  // number of threads may call it at once (while no set/del/reset runs).
+  // The caller must hold an Epoch_Guard (see "epoch.hh"): the returned bytes
+  // stay valid until it is released, even if the key is overwritten or deleted
+  // in the meantime. The hit reaches the evictor at the next set/del, or
+  // sooner if a reader's touch buffer fills up (see "basic_cache.hh").
+  val_type get_shared(const key_type& key, size_type& val_size) const;
+
+  // False if key is certainly not in the cache, true if it may be (a Bloom
+  // filter's answer; see "key_filter.hh"). Like get_shared() it needs an
+  // Epoch_Guard, but it may even run while a set/del/reset is going on, so
+  // callers can turn away lookups for absent keys before taking any lock.
+  bool may_contain(std::string_view key) const;
+
+  // Number of bytes at val, a pointer returned by get() or get_shared(). Unlike
+  // strlen() this counts through any NULs stored inside a binary value.
+  std::size_t stored_length(val_type val) const;
+
   // Delete an object from the cache, if it's still there
-  bool del(key_type key);
+  bool del(std::string_view key);
+
+  // Number of values set with a TTL that are still stored. When it's zero
+  // expire() has nothing to do, and this is cheap to ask under a shared lock.
+  std::size_t ttl_entries() const;
+
+  // Remove up to 'budget' expired values. Returns how many were removed;
+  // if that's 'budget', call again for the rest.
+  std::size_t expire(std::size_t budget);
 
-  // Compute the total amount of memory used up by all cache values (not keys)
+  // Evict until at most 'target' bytes are charged against maxmem, so later
+  // sets find room without evicting. Returns the bytes freed.
+  size_type evict_to(size_type target);
+
+  // Compute the total amount charged against maxmem: the sizes of all cache
+  // values, or with count_overhead their full footprint
   size_type space_used() const;
 
+  // Estimate the memory actually held by the cache: value storage (including
+  // unused arena space), keys, and per-entry index overhead.
+  std::size_t memory_used() const;
+
+  // Snapshot of internal counters (entry count, per-slab-class occupancy and
+  // fragmentation, ...), keyed by name.
+  stats_type stats() const;
+
   // Delete all data from the cache
   void reset();
+
+  // Whether any Value_Handle still refers to the cache's values. The cache
+  // must not be destroyed while one does. Takes time in proportion to the
+  // number of entries.
+  bool pinned() const;
 };
 
@@ -7,9 +7,12 @@
 #include <boost/asio/connect.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/algorithm/string.hpp>
+#include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <sstream>
 #include <iostream>
 #include "cache.hh"
 
@@ -57,7 +60,7 @@ public:
         */
     }
 
-    void set(key_type key, val_type val, size_type size) {
+    void set(key_type key, val_type val, size_type size, ttl_type ttl) {
 
         //std::cout << "\nBeginning set request...\n";
 
@@ -67,6 +70,10 @@ public:
 
         // Set up an HTTP SET request message
         std::string requestBody = "/" + key + "/" + val + "/" + std::to_string(size);
+        // The TTL, in milliseconds, is an optional fourth field
+        if (ttl > ttl_type::zero()) {
+            requestBody += "/" + std::to_string(ttl.count());
+        }
         //std::cout << "The client asked (set): " << requestBody << "\n";
         http::request<http::string_body> req{ http::verb::put, requestBody, HTTPVersion_ };
         req.set(http::field::host, host_);
@@ -91,6 +98,27 @@ public:
         http::read(stream_, buffer, res);
     }
 
+    // Binary-safe set: PUT /k/s (or /k/s/ttl) with the value's bytes as the
+    // whole body, so NULs and slashes in it arrive intact
+    void set_bytes(std::string_view key, std::string_view val, size_type size, ttl_type ttl) {
+        std::string target = "/" + key_type(key) + "/" + std::to_string(size);
+        if (ttl > ttl_type::zero()) {
+            target += "/" + std::to_string(ttl.count());
+        }
+        http::request<http::string_body> req{ http::verb::put, target, HTTPVersion_ };
+        req.set(http::field::host, host_);
+        req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+        req.set(http::field::content_type, "application/octet-stream");
+        req.body().assign(val.data(), val.size());
+        req.prepare_payload();
+
+        http::write(stream_, req);
+
+        beast::flat_buffer buffer;
+        http::response<http::string_body> res;
+        http::read(stream_, buffer, res);
+    }
+
     val_type get(key_type key, size_type& val_size) {
 
         //std::cout << "\nBeginning get request...\n";
@@ -133,7 +161,7 @@ public:
         //std::cout << "val: " << val << "\n";
         std::string val_size_string = splitBody[5].substr(2, splitBody[5].size() - 3); // Changed
         //std::cout << "val_size_string = " << val_size_string << "\n";
-        val_size = std::stoi(val_size_string);
+        val_size = std::stoull(val_size_string);
         return val;
     }
 
@@ -200,13 +228,52 @@ public:
 
         //Print is new
         std::cout << "Before string conversion: " << res["Space-Used"] << "\n";
-        std::string space_used_string = res["Space-Used"].data();
+        std::string space_used_string(res["Space-Used"].data(), res["Space-Used"].size());
         //Print is new
         std::cout << "After conversion: " << space_used_string << "\n";
-        Cache::size_type space_used_return = std::stoi(space_used_string);
+        Cache::size_type space_used_return = std::stoull(space_used_string);
         return space_used_return;
     }
 
+    std::size_t memory_used() {
+        // Same HEAD request as space_used(), reading the other header
+        http::request<http::string_body> req{http::verb::head, "/", HTTPVersion_};
+        req.set(http::field::host, host_);
+        req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+        req.prepare_payload();
+        http::write(stream_, req);
+
+        beast::flat_buffer buffer;
+        http::response<http::string_body> res;
+        http::read(stream_, buffer, res);
+
+        std::string memory_used_string(res["Memory-Used"].data(), res["Memory-Used"].size());
+        return std::stoull(memory_used_string);
+    }
+
+    stats_type stats() {
+        // The server answers POST /stats with one "name value" pair per line
+        http::request<http::string_body> req{ http::verb::post, "/stats", HTTPVersion_ };
+        req.set(http::field::host, host_);
+        req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+        req.body() = "/stats";
+        req.prepare_payload();
+        http::write(stream_, req);
+
+        beast::flat_buffer buffer;
+        http::response<http::string_body> res;
+        http::read(stream_, buffer, res);
+
+        stats_type result;
+        std::istringstream lines(res.body());
+        std::string name;
+        double value;
+        while (lines >> name >> value) {
+            result[name] = value;
+        }
+        return result;
+    }
+
     void reset() {
 
         std::cout << "\nBeginning a reset request...\n";
@@ -241,10 +308,43 @@ pImpl_(new Impl(host, port))
     std::cout << "Cache constructed\n";
 }
 
-void Cache::set(key_type key, val_type val, size_type size) { pImpl_->set(key, val, size); }
+void Cache::set(key_type key, val_type val, size_type size, ttl_type ttl) { pImpl_->set(key, val, size, ttl); }
+void Cache::set(std::string_view key, std::string_view val, size_type size, ttl_type ttl) { pImpl_->set_bytes(key, val, size, ttl); }
+void Cache::set(key_type&& key, std::string&& val, size_type size, ttl_type ttl) { pImpl_->set_bytes(key, val, size, ttl); }
 Cache::val_type Cache::get(key_type key, size_type& val_size) const { return pImpl_->get(key, val_size); }
-bool Cache::del(key_type key) { return pImpl_->del(key); }
+// The handle owns a copy of the value the server sent back
+Cache::Value_Handle Cache::get(std::string_view key) const {
+    size_type size = 0;
+    if (pImpl_->get(key_type(key), size) == nullptr) {
+        return Value_Handle();
+    }
+    const std::string& val = pImpl_->get_val_;
+    char* copy = new char[val.size() + 1];
+    std::memcpy(copy, val.c_str(), val.size() + 1);
+    return Value_Handle(copy, val.size(), size, [](const char* data) { delete[] data; });
+}
+// The value is the client's own copy, valid until its next get, so there's
+// nothing for an Epoch_Guard to protect
+Cache::val_type Cache::get_shared(const key_type& key, size_type& val_size) const { return pImpl_->get(key, val_size); }
+// The server filters its own lookups; the client has no filter to ask, and
+// "may be present" is always a correct answer
+bool Cache::may_contain(std::string_view) const { return true; }
+std::size_t Cache::stored_length(val_type val) const { return std::strlen(val); }
+bool Cache::del(std::string_view key) { return pImpl_->del(key_type(key)); }
+// The server's maintenance thread expires values on its own, so there are
+// never any here for the client to remove
+std::size_t Cache::expire(std::size_t) { return 0; }
+// Background eviction is the server's to configure (its -w and -l options)
+Cache::size_type Cache::evict_to(size_type) {
+    assert(false && "evict_to() is not supported over the network; start the server with -w\n");
+    return 0;
+}
 Cache::size_type Cache::space_used() const { return pImpl_->space_used(); }
+std::size_t Cache::memory_used() const { return pImpl_->memory_used(); }
+Cache::stats_type Cache::stats() const { return pImpl_->stats(); }
+std::size_t Cache::ttl_entries() const { return pImpl_->stats()["ttl_entries"]; }
 void Cache::reset() { pImpl_->reset(); }
+// Handles from the client own copies, never the server's storage
+bool Cache::pinned() const { return false; }
 Cache::~Cache() {} // Previously called pImpl_.reset(), but had to be removed due to unknown Seg Fault-ing
                    // Regardless, valgrind confirms that our cache leaks no memory
\ No newline at end of file
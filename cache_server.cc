@@ -10,6 +10,7 @@
 #include <boost/program_options.hpp>
 #include <boost/algorithm/string.hpp>
 #include <algorithm>
+#include <array>
 #include <cstdlib>
 #include <functional>
 #include <iostream>
@@ -18,9 +19,19 @@
 #include <thread>
 #include <vector>
 #include <sstream>
-#include <mutex>
-#include "cache.hh"
+#include "epoch.hh"
+#include "sharded_cache.hh"
 #include "lru_evictor.hh"
+#include "clock_evictor.hh"
+#include "clock_pro_evictor.hh"
+#include "slru_evictor.hh"
+#include "arc_evictor.hh"
+#include "fifo_evictor.hh"
+#include "s3fifo_evictor.hh"
+#include "lfu_evictor.hh"
+#include "gdsf_evictor.hh"
+#include "sampled_lru_evictor.hh"
+#include "tinylfu_evictor.hh"
 
 namespace beast = boost::beast;         // from <boost/beast.hpp>
 namespace http = beast::http;           // from <boost/beast/http.hpp>
@@ -28,7 +39,58 @@ namespace net = boost::asio;            // from <boost/asio.hpp>
 namespace po = boost::program_options;
 using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
 
-std::mutex cache_mutex;
+//------------------------------------------------------------------------------
+
+// Body type for GET responses. The value is sent straight out of cache
+// storage: the writer hands Beast the text around the value plus a buffer
+// pointing at the handle's bytes, and the handle keeps those bytes alive
+// until the response has been written and destroyed.
+struct value_handle_body
+{
+    struct value_type
+    {
+        std::string prefix;
+        Cache::Value_Handle handle;
+        std::string suffix;
+    };
+
+    static std::uint64_t
+        size(value_type const& body)
+    {
+        return body.prefix.size() + body.handle.length() + body.suffix.size();
+    }
+
+    class writer
+    {
+        value_type const& body_;
+
+    public:
+        using const_buffers_type = std::array<net::const_buffer, 3>;
+
+        template<bool isRequest, class Fields>
+        writer(http::header<isRequest, Fields> const&, value_type const& body)
+            : body_(body)
+        {
+        }
+
+        void
+            init(beast::error_code& ec)
+        {
+            ec = {};
+        }
+
+        // Everything is already in memory, so it all goes out in one step
+        boost::optional<std::pair<const_buffers_type, bool>>
+            get(beast::error_code& ec)
+        {
+            ec = {};
+            return {{ const_buffers_type{
+                net::buffer(body_.prefix),
+                net::buffer(body_.handle.data(), body_.handle.length()),
+                net::buffer(body_.suffix) }, false }};
+        }
+    };
+};
 
 //------------------------------------------------------------------------------
 
@@ -41,7 +103,7 @@ template<
     class Send>
     void
     handle_request(
-        Cache* serverCache,
+        ShardedCache* serverCache,
         http::request<Body, http::basic_fields<Allocator>>&& req,
         Send&& send)
 {
@@ -73,6 +135,7 @@ template<
         std::cout << "Handling a HEAD request...\n";
         http::response<http::empty_body> res { http::status::ok, req.version() };
         res.insert("Space-Used", std::to_string(serverCache->space_used()));
+        res.insert("Memory-Used", std::to_string(serverCache->memory_used()));
         res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
         res.set(http::field::accept, "/k/v");
         res.set(http::field::content_type, "application/json");
@@ -91,65 +154,66 @@ template<
         boost::split(splitBody, req.body(), boost::is_any_of("/")); // Uses body now
         assert(splitBody.size() == 2 && "splitBody was the wrong size (get)\n");
         //
-        Cache::size_type val_size;
-        cache_mutex.lock();
-        Cache::val_type result = serverCache->get(splitBody[1], val_size);
-        cache_mutex.unlock();
-        //std::cout << "Server thinks the key is: " << splitBody[1] << "\n";
-        //std::cout << "Server thinks the data is: " << result << "\n";
-        //std::cout << "Server thinks the val size is: " << val_size << "\n";
-        http::response<http::string_body> res{ http::status::ok, req.version() };
-        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-        std::string bodyMessage;
-        if (result == nullptr) {
-            bodyMessage = std::string("NULL");
+        Cache::Value_Handle handle = serverCache->get(splitBody[1]);
+        if (!handle) {
+            http::response<http::string_body> res{ http::status::ok, req.version() };
+            res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+            res.body() = "NULL";
+            res.keep_alive(req.keep_alive());
+            res.prepare_payload();
+            return send(std::move(res));
         }
-        else {
-            std::string gotValue = result;
-            bodyMessage = std::string("\"key\": \"") + 
-                          splitBody[1] + 
-                          std::string("\", \"value\": \"") + 
-                          gotValue + 
-                          std::string("\", \"size\": \"") +
-                          std::to_string(val_size) +
-                          std::string("\"");
-        }
-        std::cout << "Sending this back: " << bodyMessage << "\n";
-        res.body() = bodyMessage;
-        auto const size = bodyMessage.size();
-        res.content_length(size);
+        // The value itself is never copied: the response body references it
+        http::response<value_handle_body> res{ http::status::ok, req.version() };
+        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        res.body().prefix = std::string("\"key\": \"") + splitBody[1] + std::string("\", \"value\": \"");
+        res.body().suffix = std::string("\", \"size\": \"") + std::to_string(handle.size()) + std::string("\"");
+        res.body().handle = std::move(handle);
         res.keep_alive(req.keep_alive());
         res.prepare_payload();
         return send(std::move(res));
     }
 
-    // Respond to PUT /k/v/s request
+    // Respond to PUT /k/v/s request, or PUT /k/v/s/ttl with a TTL in milliseconds.
+    // An application/octet-stream PUT /k/s[/ttl] carries the value's raw bytes
+    // as its body instead, so it may hold NULs and slashes.
     if (req.method() == http::verb::put) {
         std::cout << "Handling a PUT request...\n";
         // http://www.martinbroadhurst.com/how-to-split-a-string-in-c.html, method 5
         std::vector<std::string> splitBody;
         // std::cout << "The server recieved this set request: " << req.body() << "\n";
-        boost::split(splitBody, req.body(), boost::is_any_of("/")); // Uses body now
-        assert(splitBody.size() == 4 && "splitBody was the wrong size (put)\n");
+        if (req[http::field::content_type] == "application/octet-stream") {
+            boost::split(splitBody, req.target(), boost::is_any_of("/"));
+            splitBody.insert(splitBody.begin() + 2, std::move(req.body()));
+        }
+        else {
+            boost::split(splitBody, req.body(), boost::is_any_of("/")); // Uses body now
+        }
+        assert((splitBody.size() == 4 || splitBody.size() == 5) && "splitBody was the wrong size (put)\n");
         Cache::size_type size;
         // std::cout << "Before conversion: " << splitBody[3] << "\n";
         std::stringstream ss(splitBody[3]);
         ss >> size;
-        Cache::val_type val = splitBody[2].c_str();
+        ShardedCache::ttl_type ttl = ShardedCache::ttl_type::zero();
+        if (splitBody.size() == 5) {
+            std::stringstream ttl_ss(splitBody[4]);
+            long long ms = 0;
+            ttl_ss >> ms;
+            ttl = ShardedCache::ttl_type(ms);
+        }
         // std::cout << "Key: " << splitBody[1] << "\n";
-        // std::cout << "Value: " << val << "\n";
+        // std::cout << "Value: " << splitBody[2] << "\n";
         // std::cout << "Size: " << size << "\n";
-        cache_mutex.lock();
-        serverCache->set(splitBody[1], val, size);
-        cache_mutex.unlock();
+        // Hand over the parsed strings: the key moves into the index as is,
+        // and the value is copied once, straight into cache storage
+        serverCache->set(std::move(splitBody[1]), std::move(splitBody[2]), size, ttl);
 
         /*
         // Test:
         Cache::size_type gotten_size;
         // std::cout << "Testing get in set function!\n";
-        cache_mutex.lock();
-        std::string gotten_data( serverCache->get(splitBody[1], gotten_size) );
-        cache_mutex.unlock();
+        std::string gotten_data;
+        serverCache->get(splitBody[1], gotten_data, gotten_size);
         std::cout << "Got data! " << gotten_data << "\n";
         std::cout << "Got size! " << gotten_size << "\n";
         assert(gotten_data == splitBody[2].c_str() && gotten_size == size && "Set was bad!\n");
@@ -170,9 +234,7 @@ template<
         boost::split(splitBody, req.body(), boost::is_any_of("/"));
         assert(splitBody.size() == 2 && "splitBody was the wrong size (put)\n");
         //
-        cache_mutex.lock();
         bool answer = serverCache->del(splitBody[1]);
-        cache_mutex.unlock();
         http::response<http::string_body> res{ http::status::ok, req.version() };
         res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
         //Computer is unhappy with boolean concatenation.
@@ -192,19 +254,33 @@ template<
         return send(std::move(res));
     }
 
-    // Respond to POST /reset request. POST /"anything else" should fail.
+    // Respond to POST /reset and POST /stats requests. POST /"anything else" should fail.
     if (req.method() == http::verb::post) {
         std::cout << "Handling a POST request...\n";
         // http://www.martinbroadhurst.com/how-to-split-a-string-in-c.html, method 5
         std::vector<std::string> splitBody;
         boost::split(splitBody, req.body(), boost::is_any_of("/"));
-        
+
+        // Stats are sent back as one "name value" pair per line
+        if (splitBody.size() == 2 && splitBody[1] == "stats") {
+            Cache::stats_type stats = serverCache->stats();
+            std::string bodyMessage;
+            for (const auto& stat : stats) {
+                bodyMessage += stat.first + " " + std::to_string(stat.second) + "\n";
+            }
+            http::response<http::string_body> res{ http::status::ok, req.version() };
+            res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+            res.set(http::field::content_type, "text/plain");
+            res.body() = bodyMessage;
+            res.keep_alive(req.keep_alive());
+            res.prepare_payload();
+            return send(std::move(res));
+        }
+
         http::response<http::empty_body> res{ http::status::ok, req.version() };
         assert(splitBody.size() == 2 && "splitBody was the wrong size (put)\n");
         if (splitBody[1] == "reset") {
-            cache_mutex.lock();
             serverCache->reset();
-            cache_mutex.unlock();
             assert(serverCache->space_used() == 0 && "Reset failed!\n");
         }
         else {
@@ -269,7 +345,7 @@ class session : public std::enable_shared_from_this<session>
 
     beast::tcp_stream stream_;
     beast::flat_buffer buffer_;
-    Cache* serverCache_;
+    ShardedCache* serverCache_;
     http::request<http::string_body> req_;
     std::shared_ptr<void> res_;
     send_lambda lambda_;
@@ -278,7 +354,7 @@ public:
     // Take ownership of the stream
     session(
         tcp::socket&& socket,
-        Cache* serverCache)
+        ShardedCache* serverCache)
         : stream_(std::move(socket))
         , serverCache_(serverCache)
         , lambda_(*this)
@@ -378,13 +454,13 @@ class listener : public std::enable_shared_from_this<listener>
 {
     net::io_context& ioc_;
     tcp::acceptor acceptor_;
-    Cache* serverCache_;
+    ShardedCache* serverCache_;
 
 public:
     listener(
         net::io_context& ioc,
         tcp::endpoint endpoint,
-        Cache* serverCache)
+        ShardedCache* serverCache)
         : ioc_(ioc)
         , acceptor_(net::make_strand(ioc))
         , serverCache_(serverCache)
@@ -473,7 +549,14 @@ int main(int argc, char** argv) {
         ("-s", po::value<std::string>()->default_value("127.0.0.1"), "define host server (default 127.0.0.1)")
         ("-p", po::value<unsigned short>()->default_value(3618), "define port number (default 3618)")
         ("-t", po::value<int>()->default_value(1), "define thread count (default 1)")
-        ("-m", po::value<Cache::size_type>()->default_value(1024), "set maxmem (default 10)");
+        ("-m", po::value<Cache::size_type>()->default_value(1024), "set maxmem in bytes (default 1024)")
+        ("-o", po::bool_switch(), "charge keys, index and allocator overhead against maxmem")
+        ("-e", po::value<std::string>()->default_value("lru"), "eviction policy: lru, sampled-lru, slru, arc, clock, clock-pro, fifo, s3fifo, lfu or gdsf (default lru)")
+        ("-a", po::bool_switch(), "admit new keys through a W-TinyLFU filter in front of the -e policy")
+        ("-r", po::value<double>()->default_value(0.8), "share of keys SLRU may protect (default 0.8)")
+        ("-w", po::value<double>()->default_value(0), "evict in the background once a shard is this full, 0 to 1 (default 0: off)")
+        ("-l", po::value<double>(), "background eviction stops at this fill (default 0.9 of -w)")
+        ("-n", po::value<int>()->default_value(0), "define cache shard count (default: one per thread)");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -482,16 +565,82 @@ int main(int argc, char** argv) {
     net::ip::address const address = net::ip::make_address(vm["-s"].as<std::string>());
     unsigned short const port = vm["-p"].as<unsigned short>();
     auto const threads = vm["-t"].as<int>();
+    // Every thread that reads the cache needs an epoch slot, the maintenance
+    // and reset threads included
+    if (threads < 1 || threads > static_cast<int>(Epoch_Manager::MAX_THREADS) - 2) {
+        std::cerr << "-t needs 1 to " << Epoch_Manager::MAX_THREADS - 2 << " threads\n";
+        return EXIT_FAILURE;
+    }
     auto const maxmem = vm["-m"].as<Cache::size_type>();
-    std::cout << "Created cache of size " << maxmem << " with " << threads << " threads\n";
+    auto const shards = vm["-n"].as<int>() > 0 ? vm["-n"].as<int>() : threads;
+    bool const count_overhead = vm["-o"].as<bool>();
+    auto const policy = vm["-e"].as<std::string>();
+    ShardedCache::evictor_factory make_evictor;
+    if (policy == "lru") {
+        make_evictor = [] { return std::unique_ptr<Evictor>(new LRU_Evictor()); };
+    }
+    else if (policy == "sampled-lru") {
+        make_evictor = [] { return std::unique_ptr<Evictor>(new Sampled_LRU_Evictor()); };
+    }
+    else if (policy == "slru") {
+        double const protected_ratio = vm["-r"].as<double>();
+        make_evictor = [protected_ratio] {
+            return std::unique_ptr<Evictor>(new SLRU_Evictor(protected_ratio));
+        };
+    }
+    else if (policy == "arc") {
+        make_evictor = [] { return std::unique_ptr<Evictor>(new ARC_Evictor()); };
+    }
+    else if (policy == "clock") {
+        make_evictor = [] { return std::unique_ptr<Evictor>(new Clock_Evictor()); };
+    }
+    else if (policy == "clock-pro") {
+        make_evictor = [] { return std::unique_ptr<Evictor>(new Clock_Pro_Evictor()); };
+    }
+    else if (policy == "fifo") {
+        make_evictor = [] { return std::unique_ptr<Evictor>(new FIFO_Evictor()); };
+    }
+    else if (policy == "s3fifo") {
+        make_evictor = [] { return std::unique_ptr<Evictor>(new S3FIFO_Evictor()); };
+    }
+    else if (policy == "lfu") {
+        make_evictor = [] { return std::unique_ptr<Evictor>(new LFU_Evictor()); };
+    }
+    else if (policy == "gdsf") {
+        make_evictor = [] { return std::unique_ptr<Evictor>(new GDSF_Evictor()); };
+    }
+    else {
+        std::cerr << "Unknown eviction policy " << policy << "\n";
+        return EXIT_FAILURE;
+    }
+    if (vm["-a"].as<bool>()) {
+        make_evictor = [main = make_evictor] {
+            return std::unique_ptr<Evictor>(new TinyLFU_Evictor(main()));
+        };
+    }
+    double const high_watermark = vm["-w"].as<double>();
+    double const low_watermark = vm.count("-l") ? vm["-l"].as<double>() : 0.9 * high_watermark;
+    // Same bounds start_maintenance() asserts
+    if (high_watermark != 0 && !(0 <= low_watermark && low_watermark <= high_watermark && high_watermark <= 1)) {
+        std::cerr << "Watermarks need 0 <= -l <= -w <= 1\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "Created cache of size " << maxmem << " with " << threads << " threads and "
+              << shards << " shards, " << policy << " eviction\n";
     std::cout << "Operating with address " << address << ", on port " << port << ".\n";
 
-    // Evictor implementation is new
-    // FIFO_Evictor f_evictor = FIFO_Evictor();
-    LRU_Evictor lru_evictor = LRU_Evictor();
-
-    Cache serverCache = Cache(maxmem, 0.75, &lru_evictor);
-    Cache* s_cache = &serverCache;
+    // Each shard gets its own evictor and its own lock
+    ShardedCache serverCache(shards, maxmem, 0.75, make_evictor, count_overhead);
+    ShardedCache* s_cache = &serverCache;
+    // The maintenance thread always runs, to reclaim expired values
+    if (high_watermark != 0) {
+        serverCache.start_maintenance(high_watermark, low_watermark);
+        std::cout << "Evicting in the background from " << high_watermark << " down to "
+                  << low_watermark << " of each shard\n";
+    }
+    else {
+        serverCache.start_maintenance(1, 1);
+    }
 
     // The io_context is required for all I/O
     net::io_context ioc{ threads };
@@ -0,0 +1,84 @@
+/*
+ * Implementation of the Clock_Evictor declared in clock_evictor.hh.
+ */
+
+#include "clock_evictor.hh"
+
+void
+Clock_Evictor::touch_key(const key_type& key)
+// New keys start unreferenced; known keys get their bit set
+{
+    std::size_t hash = nodes_.hash(key);
+    uint32_t n = nodes_.find(key, hash);
+    if (n == NIL) {
+        n = nodes_.insert(key, hash);
+        nodes_[n].referenced.store(false, std::memory_order_relaxed);
+        clock_.push_back(nodes_, n);
+    }
+    else {
+        nodes_[n].referenced.store(true, std::memory_order_relaxed);
+    }
+}
+
+void
+Clock_Evictor::forget_key(const key_type& key)
+{
+    uint32_t n = nodes_.find(key, nodes_.hash(key));
+    if (n != NIL) {
+        clock_.unlink(nodes_, n);
+        nodes_.erase(n);
+    }
+}
+
+void
+Clock_Evictor::clear()
+{
+    nodes_.clear();
+    clock_ = Index_List();
+}
+
+void
+Clock_Evictor::mark_key(const key_type& key) const
+{
+    uint32_t n = nodes_.find(key, nodes_.hash(key));
+    if (n != NIL) {
+        nodes_[n].referenced.store(true, std::memory_order_relaxed);
+    }
+}
+
+uint32_t
+Clock_Evictor::sweep()
+// Moves the hand on to an unreferenced key, clearing the bits it passes;
+// at most one turn
+{
+    for (;;) {
+        uint32_t n = clock_.head;
+        Node& node = nodes_[n];
+        if (!node.referenced.load(std::memory_order_relaxed)) {
+            return n;
+        }
+        node.referenced.store(false, std::memory_order_relaxed);
+        clock_.unlink(nodes_, n);
+        clock_.push_back(nodes_, n);
+    }
+}
+
+const key_type
+Clock_Evictor::evict()
+{
+    if (nodes_.size() == 0) {
+        return "";
+    }
+    uint32_t n = sweep();
+    clock_.unlink(nodes_, n);
+    key_type k = nodes_[n].key;
+    nodes_.erase(n);
+    return k;
+}
+
+const key_type
+Clock_Evictor::peek_victim()
+// Leaves the hand on the key, for evict() to take
+{
+    return nodes_.size() == 0 ? "" : nodes_[sweep()].key;
+}
@@ -0,0 +1,68 @@
+/*
+ * Declarations for a CLOCK eviction policy according to the pattern in evictor.hh.
+ * Implemented in clock_evictor.cc.
+ *
+ * CLOCK approximates LRU with one reference bit per key. A hit only sets the
+ * bit, so it needs no list surgery and no exclusive lock: mark_key() does it
+ * with a relaxed atomic store. To evict, a hand sweeps over the keys in a
+ * fixed circular order, clearing set bits, and takes the first key whose bit
+ * was already clear. A key that was hit since the hand last passed it gets a
+ * second chance.
+ *
+ * The circle is a list of the live keys, with the hand at its head: passing
+ * a key moves it to the tail, and new keys join at the tail, right behind
+ * the hand. So every step of a sweep lands on a key, however many have been
+ * forgotten, and a new key gets a full turn before it's considered.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "evictor.hh"
+#include "key_table.hh"
+
+class Clock_Evictor final : public Evictor {
+private:
+    struct Node {
+        key_type key;
+        std::size_t hash;
+        uint32_t prev;  // Towards the hand
+        uint32_t next;  // Away from the hand
+        mutable std::atomic<bool> referenced{false};
+
+        Node() = default;
+        Node(Node&& other) noexcept
+            : key(std::move(other.key)), hash(other.hash), prev(other.prev), next(other.next),
+              referenced(other.referenced.load(std::memory_order_relaxed)) {}
+    };
+    using Table = Key_Table<Node>;
+    static constexpr uint32_t NIL = Table::NIL;
+
+    Table nodes_;
+    Index_List clock_;      // Head is the key under the hand
+
+    uint32_t sweep();
+
+public:
+    Clock_Evictor() = default;
+    Clock_Evictor(const Clock_Evictor&) = delete;
+    Clock_Evictor& operator=(const Clock_Evictor&) = delete;
+
+    void touch_key(const key_type&) override;
+    const key_type evict() override;
+    const key_type peek_victim() override;
+    bool empty() const override { return size() == 0; }
+    uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                         std::vector<key_type>& victims) override {
+        return evict_bytes_of(*this, bytes, size_of, victims);
+    }
+    void forget_key(const key_type&) override;
+    void clear() override;
+
+    bool concurrent_marks() const override { return true; }
+    void mark_key(const key_type&) const override;
+
+    // Number of keys currently tracked
+    std::size_t size() const { return nodes_.size(); }
+};
@@ -0,0 +1,182 @@
+/*
+ * Implementation of the Clock_Pro_Evictor declared in clock_pro_evictor.hh.
+ */
+
+#include "clock_pro_evictor.hh"
+
+void
+Clock_Pro_Evictor::push(Type type, uint32_t n)
+// Appends n to the tail of its new type's queue, the last place the hand reaches
+{
+    Queue& queue = queues_[type];
+    Node& node = nodes_[n];
+    node.type = type;
+    node.prev = queue.tail;
+    node.next = NIL;
+    if (queue.tail == NIL) queue.head = n;
+    else nodes_[queue.tail].next = n;
+    queue.tail = n;
+    ++queue.size;
+}
+
+void
+Clock_Pro_Evictor::remove(uint32_t n)
+{
+    Node& node = nodes_[n];
+    Queue& queue = queues_[node.type];
+    if (node.prev == NIL) queue.head = node.next;
+    else nodes_[node.prev].next = node.next;
+    if (node.next == NIL) queue.tail = node.prev;
+    else nodes_[node.next].prev = node.prev;
+    --queue.size;
+}
+
+uint32_t
+Clock_Pro_Evictor::pop(Type type)
+// Takes the key under the hand
+{
+    uint32_t n = queues_[type].head;
+    remove(n);
+    return n;
+}
+
+void
+Clock_Pro_Evictor::run_hand_hot()
+// Demotes the next hot key not referenced since the last pass
+{
+    uint32_t n = pop(HOT);
+    Node& node = nodes_[n];
+    if (node.referenced.load(std::memory_order_relaxed)) {
+        node.referenced.store(false, std::memory_order_relaxed);
+        push(HOT, n);
+    }
+    else {
+        push(COLD, n);
+    }
+}
+
+void
+Clock_Pro_Evictor::run_hand_test()
+// Ends the oldest test period: that key didn't come back in time
+{
+    uint32_t n = pop(TEST);
+    nodes_.erase(n);
+    if (cold_target_ > 1) --cold_target_;
+}
+
+void
+Clock_Pro_Evictor::balance()
+// Keeps hot keys within what the cold target leaves them, and test entries
+// no more numerous than resident ones
+{
+    while (queues_[HOT].size > 0 && queues_[HOT].size + cold_target_ > capacity_) {
+        run_hand_hot();
+    }
+    while (queues_[TEST].size > capacity_) {
+        run_hand_test();
+    }
+}
+
+void
+Clock_Pro_Evictor::touch_key(const key_type& key)
+{
+    std::size_t hash = nodes_.hash(key);
+    uint32_t n = nodes_.find(key, hash);
+    if (n == NIL) {
+        n = nodes_.insert(key, hash);
+        nodes_[n].referenced.store(false, std::memory_order_relaxed);
+        push(COLD, n);
+        return;
+    }
+    Node& node = nodes_[n];
+    if (node.type != TEST) {
+        node.referenced.store(true, std::memory_order_relaxed);
+        return;
+    }
+    // Back within its test period: its reuse distance is short, so it
+    // returns hot, and cold keys get more room to prove themselves.
+    if (cold_target_ + 1 < capacity_) ++cold_target_;
+    remove(n);
+    node.referenced.store(false, std::memory_order_relaxed);
+    push(HOT, n);
+    balance();
+}
+
+void
+Clock_Pro_Evictor::forget_key(const key_type& key)
+// Only resident keys; a test entry is already gone from the cache
+{
+    uint32_t n = nodes_.find(key, nodes_.hash(key));
+    if (n != NIL && nodes_[n].type != TEST) {
+        remove(n);
+        nodes_.erase(n);
+    }
+}
+
+void
+Clock_Pro_Evictor::clear()
+{
+    nodes_.clear();
+    for (Queue& queue : queues_) {
+        queue = Queue();
+    }
+    capacity_ = 0;
+    cold_target_ = 1;
+}
+
+void
+Clock_Pro_Evictor::mark_key(const key_type& key) const
+{
+    uint32_t n = nodes_.find(key, nodes_.hash(key));
+    if (n != NIL && nodes_[n].type != TEST) {
+        nodes_[n].referenced.store(true, std::memory_order_relaxed);
+    }
+}
+
+uint32_t
+Clock_Pro_Evictor::run_hand_cold()
+// Promotes cold keys under the hand until it reaches one not referenced,
+// which it leaves there. NIL if there are no resident keys.
+{
+    capacity_ = size();
+    if (capacity_ == 0) {
+        return NIL;
+    }
+    if (cold_target_ >= capacity_) cold_target_ = capacity_ > 1 ? capacity_ - 1 : 1;
+    balance();
+    // balance() leaves at least one cold key, and every promotion below is
+    // balanced by demoting a hot key whose bit is clear, so this ends.
+    for (;;) {
+        uint32_t n = queues_[COLD].head;
+        Node& node = nodes_[n];
+        if (!node.referenced.load(std::memory_order_relaxed)) {
+            return n;
+        }
+        // Reused while cold: promote it
+        remove(n);
+        node.referenced.store(false, std::memory_order_relaxed);
+        push(HOT, n);
+        balance();
+    }
+}
+
+const key_type
+Clock_Pro_Evictor::evict()
+{
+    uint32_t n = run_hand_cold();
+    if (n == NIL) {
+        return "";
+    }
+    remove(n);
+    push(TEST, n);
+    key_type k = nodes_[n].key;
+    balance();
+    return k;
+}
+
+const key_type
+Clock_Pro_Evictor::peek_victim()
+{
+    uint32_t n = run_hand_cold();
+    return n == NIL ? "" : nodes_[n].key;
+}
@@ -0,0 +1,102 @@
+/*
+ * Declarations for a CLOCK-Pro eviction policy according to the pattern in evictor.hh.
+ * Implemented in clock_pro_evictor.cc.
+ *
+ * CLOCK-Pro (Jiang, Chen and Zhang, USENIX ATC 2005) keeps CLOCK's cheap hits,
+ * a reference bit set by touch_key() or concurrently by mark_key(), but
+ * judges keys by reuse distance instead of recency, so a one-off scan can't
+ * flush the keys that are used over and over.
+ *
+ * Resident keys are hot or cold. New keys start cold; only cold keys are
+ * evicted. An evicted cold key stays on as a non-resident "test" entry (key
+ * only, no value) for a while. If it comes back during that time, it has a
+ * short enough reuse distance to be hot. Three hands do the work:
+ *   - the cold hand evicts unreferenced cold keys and promotes referenced ones,
+ *   - the hot hand demotes hot keys that weren't referenced since its last pass,
+ *   - the test hand drops test entries once there are more than resident keys.
+ * The share of residents kept cold adapts: it grows when test entries come
+ * back and shrinks when they expire unused.
+ *
+ * This is the simplified form most implementations use: every resident cold
+ * key is in its test period. And instead of one ring holding all three kinds
+ * of key, each kind has its own circular queue with its hand at the front,
+ * so a hand only steps over keys it acts on. (On one ring, the cold hand
+ * walks past every hot key to find the few cold ones.) Test entries expire
+ * in the order they were made rather than when the hot hand passes them.
+ *
+ * The evictor doesn't know the cache's capacity; since the cache only calls
+ * evict() when it is full, the resident count at that point stands in for it.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "evictor.hh"
+#include "key_table.hh"
+
+class Clock_Pro_Evictor final : public Evictor {
+private:
+    enum Type : uint8_t { HOT, COLD, TEST };
+
+    struct Node {
+        key_type key;
+        std::size_t hash;
+        uint32_t prev;  // Links within the queue for its type
+        uint32_t next;
+        Type type;
+        mutable std::atomic<bool> referenced{false};
+
+        Node() = default;
+        Node(Node&& other) noexcept
+            : key(std::move(other.key)), hash(other.hash), prev(other.prev), next(other.next),
+              type(other.type), referenced(other.referenced.load(std::memory_order_relaxed)) {}
+    };
+    using Table = Key_Table<Node>;
+    static constexpr uint32_t NIL = Table::NIL;
+
+    // One per Type. The hand is at the head; passing a key moves it to the tail.
+    struct Queue {
+        uint32_t head = NIL;
+        uint32_t tail = NIL;
+        std::size_t size = 0;
+    };
+
+    Table nodes_;
+    Queue queues_[3];
+    std::size_t capacity_ = 0;      // Resident keys at the last evict()
+    std::size_t cold_target_ = 1;   // Residents to keep cold
+
+    void push(Type type, uint32_t n);
+    uint32_t pop(Type type);
+    void remove(uint32_t n);
+    void run_hand_hot();
+    void run_hand_test();
+    uint32_t run_hand_cold();
+    void balance();
+
+public:
+    Clock_Pro_Evictor() = default;
+    Clock_Pro_Evictor(const Clock_Pro_Evictor&) = delete;
+    Clock_Pro_Evictor& operator=(const Clock_Pro_Evictor&) = delete;
+
+    void touch_key(const key_type&) override;
+    const key_type evict() override;
+    const key_type peek_victim() override;
+    bool empty() const override { return size() == 0; }
+    uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                         std::vector<key_type>& victims) override {
+        return evict_bytes_of(*this, bytes, size_of, victims);
+    }
+    void forget_key(const key_type&) override;
+    void clear() override;
+
+    bool concurrent_marks() const override { return true; }
+    void mark_key(const key_type&) const override;
+
+    // Resident keys, hot and cold
+    std::size_t size() const { return queues_[HOT].size + queues_[COLD].size; }
+    std::size_t hot() const { return queues_[HOT].size; }
+    // Evicted keys still remembered
+    std::size_t test() const { return queues_[TEST].size; }
+};
@@ -0,0 +1,119 @@
+/*
+ * Implementation of the Epoch_Manager declared in "epoch.hh".
+ */
+
+#include "epoch.hh"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// Each thread claims a slot on its first pin and gives it back when it exits.
+struct Epoch_Thread_Record {
+    Epoch_Manager::Slot* slot = nullptr;
+    unsigned depth = 0;
+
+    ~Epoch_Thread_Record()
+    {
+        if (slot != nullptr) {
+            slot->epoch.store(0, std::memory_order_release);
+            slot->in_use.store(false, std::memory_order_release);
+        }
+    }
+};
+
+namespace {
+thread_local Epoch_Thread_Record thread_record;
+}
+
+Epoch_Manager&
+Epoch_Manager::global()
+{
+    static Epoch_Manager manager;
+    return manager;
+}
+
+Epoch_Manager::Slot&
+Epoch_Manager::my_slot()
+{
+    if (thread_record.slot == nullptr) {
+        for (unsigned i = 0; i < MAX_THREADS; ++i) {
+            bool expected = false;
+            if (slots_[i].in_use.compare_exchange_strong(expected, true)) {
+                thread_record.slot = &slots_[i];
+                // Let scans know how far into the array they need to look
+                unsigned high = high_water_.load();
+                while (high < i + 1 && !high_water_.compare_exchange_weak(high, i + 1)) {}
+                break;
+            }
+        }
+        // Not just an assert: running on unpinned would free memory under readers
+        if (thread_record.slot == nullptr) {
+            std::fprintf(stderr, "More than %u threads pinned epochs at once\n", MAX_THREADS);
+            std::abort();
+        }
+    }
+    return *thread_record.slot;
+}
+
+void
+Epoch_Manager::enter()
+{
+    if (thread_record.depth++ > 0) return;
+    Slot& slot = my_slot();
+    // seq_cst so the pin is visible before any lookup this thread does next
+    slot.epoch.store(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+void
+Epoch_Manager::leave()
+{
+    assert(thread_record.depth > 0);
+    if (--thread_record.depth > 0) return;
+    thread_record.slot->epoch.store(0, std::memory_order_release);
+}
+
+uint64_t
+Epoch_Manager::retire_epoch()
+// Every retirement moves the epoch on, so a reader pinned before it has a
+// smaller epoch than the stamp and a reader pinned after has a larger one.
+{
+    return epoch_.fetch_add(1, std::memory_order_seq_cst);
+}
+
+uint64_t
+Epoch_Manager::oldest_pinned() const
+{
+    uint64_t oldest = UINT64_MAX;
+    unsigned high = high_water_.load(std::memory_order_acquire);
+    for (unsigned i = 0; i < high; ++i) {
+        uint64_t e = slots_[i].epoch.load(std::memory_order_seq_cst);
+        if (e != 0 && e < oldest) oldest = e;
+    }
+    return oldest;
+}
+
+bool
+Epoch_Manager::is_safe(uint64_t epoch) const
+{
+    return oldest_pinned() > epoch;
+}
+
+void
+Epoch_Manager::synchronize()
+{
+    uint64_t stamp = retire_epoch();
+    // The calling thread may itself be pinned; it can't wait on itself
+    uint64_t own = (thread_record.slot != nullptr) ? thread_record.slot->epoch.load() : 0;
+    while (true) {
+        uint64_t oldest = UINT64_MAX;
+        unsigned high = high_water_.load(std::memory_order_acquire);
+        for (unsigned i = 0; i < high; ++i) {
+            if (&slots_[i] == thread_record.slot && own != 0) continue;
+            uint64_t e = slots_[i].epoch.load(std::memory_order_seq_cst);
+            if (e != 0 && e < oldest) oldest = e;
+        }
+        if (oldest > stamp) return;
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * Epoch-based reclamation for memory read outside of any lock.
+ * Implemented in "epoch.cc".
+ *
+ * A reader pins the current epoch (with an Epoch_Guard) before it looks
+ * anything up and unpins when it is done with the bytes it found. A writer that
+ * unlinks something stamps it with retire_epoch() instead of freeing it, and
+ * frees it only once is_safe() says no reader that could have seen it is
+ * still pinned.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+class Epoch_Manager {
+ public:
+  // Threads that may pin at once. One more aborts the process, since a
+  // reader without a slot could be freed out from under.
+  static constexpr unsigned MAX_THREADS = 256;
+
+  // The process-wide manager all caches share. There is only one, since each
+  // thread's pin state is kept in a thread_local.
+  static Epoch_Manager& global();
+
+  Epoch_Manager(const Epoch_Manager&) = delete;
+  Epoch_Manager& operator=(const Epoch_Manager&) = delete;
+
+  // Pin/unpin the calling thread. Nested pins are allowed; only the outermost
+  // pair has any effect.
+  void enter();
+  void leave();
+
+  // Stamp for something that was just unlinked. Readers that pin after this
+  // call can no longer reach it.
+  uint64_t retire_epoch();
+
+  // True once no pinned thread could still be using something retired at 'epoch'.
+  bool is_safe(uint64_t epoch) const;
+
+  // Block until every thread currently pinned (other than the caller) has
+  // unpinned. Threads must not wait on anything the caller holds while pinned.
+  void synchronize();
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> epoch{0};   // 0 when the thread isn't pinned
+    std::atomic<bool> in_use{false};
+  };
+
+  Epoch_Manager() = default;
+
+  Slot& my_slot();
+  uint64_t oldest_pinned() const;
+
+  std::atomic<uint64_t> epoch_{1};
+  std::atomic<unsigned> high_water_{0};
+  Slot slots_[MAX_THREADS];
+
+  friend struct Epoch_Thread_Record;
+};
+
+// Keeps the calling thread pinned for its lifetime. Movable, so it can be
+// handed out together with the memory it protects, but it must be destroyed on
+// the thread that created it.
+class Epoch_Guard {
+ public:
+  Epoch_Guard() : active_(true) { Epoch_Manager::global().enter(); }
+  ~Epoch_Guard() { if (active_) Epoch_Manager::global().leave(); }
+
+  Epoch_Guard(Epoch_Guard&& other) noexcept : active_(other.active_) { other.active_ = false; }
+  Epoch_Guard(const Epoch_Guard&) = delete;
+  Epoch_Guard& operator=(const Epoch_Guard&) = delete;
+  Epoch_Guard& operator=(Epoch_Guard&&) = delete;
+
+ private:
+  bool active_;
+};
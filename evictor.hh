@@ -4,15 +4,19 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
+#include <vector>
 
 // Data type to use as keys for Cache and Evictors:
 using key_type = std::string;
 
 // Abstract base class to define evictions policies.
 // It allows touching a key (on a set or get event), and request for
-// eviction, which also deletes a key. There is no explicit deletion
-// mechanism other than eviction.
+// eviction, which also deletes a key. Keys that leave the cache otherwise
+// are reported through forget_key().
 class Evictor {
  public:
   Evictor() = default;
@@ -22,9 +26,86 @@ class Evictor {
   // Inform evictor that a certain key has been set or get:
   virtual void touch_key(const key_type&) = 0;
 
+  // The cache calls this form instead, with the entry's size (the bytes it
+  // charges against maxmem) and how costly a miss on it would be, relative to
+  // other keys. Size-aware policies override it; the rest see touch_key().
+  virtual void touch_key_sized(const key_type& key, uint64_t, double) { touch_key(key); }
+
+  // Like touch_key_sized(), for a key the cache has just added, so policies
+  // that treat new keys differently needn't look them up to tell.
+  virtual void insert_key(const key_type& key, uint64_t size, double cost) {
+    touch_key_sized(key, size, cost);
+  }
+
   // Request evictor for the next key to evict, and remove it from evictor.
-  // If evictor doesn't know what to evict, return an empty key ("").
+  // If evictor doesn't know what to evict, return an empty key (""). That is
+  // a valid key as well, so callers ask empty() to tell the two apart.
   virtual const key_type evict() = 0;
 
+  // Whether evict() has no key left to give
+  virtual bool empty() const = 0;
+
+  // The key evict() would return next, left where it is, so that an evict()
+  // straight after returns the same key. Finding it may still do what evict()
+  // does on the way, such as moving a CLOCK hand past referenced keys. The
+  // default evicts the key and touches it back, which is only right for
+  // policies that put it back where it was.
+  virtual const key_type peek_victim() {
+    if (empty()) {
+      return "";
+    }
+    key_type key = evict();
+    touch_key(key);
+    return key;
+  }
+
+  // Called with the caller's size for each key: how many bytes evicting it
+  // frees, 0 for a key it no longer holds.
+  using size_fn = std::function<uint64_t(const key_type&)>;
+
+  // Evict keys, appending them to 'victims', until they add up to at least
+  // 'bytes' by size_of or the evictor is empty(). Returns the bytes covered.
+  // So a cache that needs room for a large value gets it in one call.
+  virtual uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                               std::vector<key_type>& victims) {
+    return evict_bytes_of(*this, bytes, size_of, victims);
+  }
+
+  // A key left the cache some other way than evict() (a delete, say): stop
+  // tracking it. clear() forgets every key. Policies that don't override
+  // these hand back such keys from evict() later, which callers must skip.
+  virtual void forget_key(const key_type&) {}
+  virtual void clear() {}
+
+  // Policies that only need to flip a bit on a hit (such as CLOCK) can also
+  // take hits through mark_key(), which any number of threads may call at once
+  // while no touch_key() or evict() runs, i.e. under a cache's shared lock.
+  // Keys the evictor doesn't know are ignored. concurrent_marks() says whether
+  // mark_key() does anything; if not, hits must go through touch_key().
+  virtual bool concurrent_marks() const { return false; }
+  virtual void mark_key(const key_type&) const {}
+  // Whether a mark is all a hit needs. Policies that pass marks on to
+  // another (TinyLFU to its main policy) but keep more per hit themselves
+  // say no, and get the hit through touch_key() later as well.
+  virtual bool marks_replace_touches() const { return concurrent_marks(); }
+
+  // Named counters about the policy's state, for the cache's stats().
+  virtual std::map<std::string, double> stats() const { return {}; }
+
   virtual ~Evictor() = default;
+
+ protected:
+  // evict_bytes() in terms of evict(). Final evictors override evict_bytes()
+  // to call this with themselves, which makes the evict() calls direct.
+  template <class Self>
+  static uint64_t evict_bytes_of(Self& self, uint64_t bytes, const size_fn& size_of,
+                                 std::vector<key_type>& victims) {
+    uint64_t covered = 0;
+    while (covered < bytes && !self.empty()) {
+      key_type key = self.evict();
+      covered += size_of(key);
+      victims.push_back(std::move(key));
+    }
+    return covered;
+  }
 };
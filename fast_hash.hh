@@ -0,0 +1,104 @@
+/*
+ * Fast non-cryptographic string hash, the default hasher for the cache's key
+ * index. It follows wyhash (https://github.com/wangyi-fudan/wyhash, public
+ * domain): input is read 8 bytes at a time and folded in with 64x64->128 bit
+ * multiplies, so short keys cost a handful of instructions and long keys run
+ * at several bytes per cycle. std::hash<std::string> in libstdc++ is a
+ * byte-at-a-time loop in comparison.
+ *
+ * Not suitable where an attacker picking keys to collide is a concern.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+class Fast_Hash {
+ public:
+  explicit Fast_Hash(uint64_t seed = 0) : seed_(seed) {}
+
+  std::size_t operator()(std::string_view key) const {
+    return hash(key.data(), key.size(), seed_);
+  }
+
+  static uint64_t hash(const void* data, std::size_t length, uint64_t seed) {
+    auto p = static_cast<const uint8_t*>(data);
+    seed ^= mix(seed ^ SECRET[0], SECRET[1]);
+    uint64_t a, b;
+    if (length <= 16) {
+      if (length >= 4) {
+        // Two overlapping 4-byte reads from each end cover 4..16 bytes
+        std::size_t mid = (length >> 3) << 2;
+        a = (read4(p) << 32) | read4(p + mid);
+        b = (read4(p + length - 4) << 32) | read4(p + length - 4 - mid);
+      }
+      else if (length > 0) {
+        a = (uint64_t(p[0]) << 16) | (uint64_t(p[length >> 1]) << 8) | p[length - 1];
+        b = 0;
+      }
+      else {
+        a = b = 0;
+      }
+    }
+    else {
+      std::size_t i = length;
+      if (i > 48) {
+        uint64_t seed1 = seed, seed2 = seed;
+        do {
+          seed = mix(read8(p) ^ SECRET[1], read8(p + 8) ^ seed);
+          seed1 = mix(read8(p + 16) ^ SECRET[2], read8(p + 24) ^ seed1);
+          seed2 = mix(read8(p + 32) ^ SECRET[3], read8(p + 40) ^ seed2);
+          p += 48;
+          i -= 48;
+        } while (i > 48);
+        seed ^= seed1 ^ seed2;
+      }
+      while (i > 16) {
+        seed = mix(read8(p) ^ SECRET[1], read8(p + 8) ^ seed);
+        i -= 16;
+        p += 16;
+      }
+      // The last 16 bytes, overlapping what was already mixed if need be
+      a = read8(p + i - 16);
+      b = read8(p + i - 8);
+    }
+    a ^= SECRET[1];
+    b ^= seed;
+    multiply(a, b);
+    return mix(a ^ SECRET[0] ^ length, b ^ SECRET[1]);
+  }
+
+ private:
+  static constexpr uint64_t SECRET[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+    0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL,
+  };
+
+  // a, b <- low and high halves of a * b
+  static void multiply(uint64_t& a, uint64_t& b) {
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 product = uint128(a) * b;
+    a = static_cast<uint64_t>(product);
+    b = static_cast<uint64_t>(product >> 64);
+  }
+  static uint64_t mix(uint64_t a, uint64_t b) {
+    multiply(a, b);
+    return a ^ b;
+  }
+
+  static uint64_t read8(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+  }
+  static uint64_t read4(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+  }
+
+  uint64_t seed_;
+};
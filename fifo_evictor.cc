@@ -9,16 +9,37 @@
  for CSCI 389 Homework #2
  */
 
-  std::deque<key_type> keys;
-
   void FIFO_Evictor::touch_key(const key_type& touchedKey){
-      keys.push_front(touchedKey);
+      // Keys already queued keep their place
+      std::size_t hash = nodes_.hash(touchedKey);
+      if (nodes_.find(touchedKey, hash) == NIL) {
+          queue_.push_back(nodes_, nodes_.insert(touchedKey, hash));
+      }
   }
 
   const key_type FIFO_Evictor::evict(){
-      // This code may cause problems if something is "double-touched", or
-      // added (and evicted) twice. Unclear.
-      auto lastVal = keys.back();
-      keys.pop_back();
-      return lastVal;
-  }
\ No newline at end of file
+      if (queue_.empty()) {
+          return "";
+      }
+      uint32_t n = queue_.pop_front(nodes_);
+      key_type oldest = nodes_[n].key;
+      nodes_.erase(n);
+      return oldest;
+  }
+
+  const key_type FIFO_Evictor::peek_victim(){
+      return queue_.empty() ? "" : nodes_[queue_.head].key;
+  }
+
+  void FIFO_Evictor::forget_key(const key_type& key){
+      uint32_t n = nodes_.find(key, nodes_.hash(key));
+      if (n != NIL) {
+          queue_.unlink(nodes_, n);
+          nodes_.erase(n);
+      }
+  }
+
+  void FIFO_Evictor::clear(){
+      nodes_.clear();
+      queue_ = Index_List();
+  }
@@ -1,7 +1,9 @@
 #pragma once
 
-#include <deque>
+#include <cstddef>
+#include <cstdint>
 #include "evictor.hh"
+#include "key_table.hh"
 
 /*
  Basic first-in-first-out (FIFO) eviction policy
@@ -12,13 +14,43 @@
  for CSCI 389 Homework #2
  */
 
-class FIFO_Evictor : public Evictor {
+// Every key is tracked once, in a Key_Table (see "key_table.hh"), so touching
+// a key that is already queued neither moves it nor adds a duplicate, and the
+// queue never holds more entries than there are keys in the cache.
+class FIFO_Evictor final : public Evictor {
   private:
-    // Deques are good for dual-ended operations (vectors have no push_front). 
-    // https://en.cppreference.com/w/cpp/container/deque
-    std::deque<key_type> keys;
+    struct Node {
+        key_type key;
+        std::size_t hash;
+        uint32_t prev;  // Towards the oldest end
+        uint32_t next;  // Towards the newest end
+    };
+    using Table = Key_Table<Node>;
+    static constexpr uint32_t NIL = Table::NIL;
+
+    Table nodes_;
+    Index_List queue_;  // Oldest key at the head
 
   public:
-    void touch_key(const key_type& touchedKey);
-    const key_type evict();
+    FIFO_Evictor() = default;
+    FIFO_Evictor(const FIFO_Evictor&) = delete;
+    FIFO_Evictor& operator=(const FIFO_Evictor&) = delete;
+
+    void touch_key(const key_type& touchedKey) override;
+    const key_type evict() override;
+    const key_type peek_victim() override;
+    bool empty() const override { return size() == 0; }
+    uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                         std::vector<key_type>& victims) override {
+        return evict_bytes_of(*this, bytes, size_of, victims);
+    }
+    void forget_key(const key_type&) override;
+    void clear() override;
+
+    // Hits don't change the order, so readers never have to be replayed
+    // under the write lock; mark_key() stays a no-op.
+    bool concurrent_marks() const override { return true; }
+
+    // Number of keys currently queued
+    std::size_t size() const { return nodes_.size(); }
 };
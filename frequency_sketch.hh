@@ -0,0 +1,137 @@
+/*
+ * Approximate access counts for TinyLFU admission (Einziger, Friedman and
+ * Manes, "TinyLFU: A Highly Efficient Cache Admission Policy", 2017).
+ *
+ * A count-min sketch of 4-bit counters, 16 to a 64-bit word and four per
+ * key, gives an upper bound on each key's recent count, up to 15. In front
+ * of it sits a doorkeeper, a Bloom filter that absorbs each key's first
+ * access, so the many keys seen only once never reach the counters. Every
+ * 'sample' accesses the counters are halved and the doorkeeper cleared, so
+ * the counts follow changes in popularity.
+ *
+ * Sized for a number of keys: the sketch has one word per two keys and the
+ * doorkeeper eight bits per key, about five bytes per key in all.
+ * Keys are given by their hash.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Frequency_Sketch {
+ public:
+  // Sizes the sketch for 'keys' keys, unless it is already at least that
+  // big. Counts carry over: a key's counters and doorkeeper bits sit at its
+  // hash's low bits, so a table grown by a power of two repeats the old one
+  // and every key reads back what it had.
+  void ensure_capacity(std::size_t keys) {
+    std::size_t words = 8;
+    while (words * 2 < keys) {
+      words *= 2;
+    }
+    std::size_t old = table_.size();
+    if (words <= old) {
+      return;
+    }
+    table_.resize(words);
+    doorkeeper_.resize(words / 4);        // 8 bits per key
+    for (std::size_t i = old; old != 0 && i < words; ++i) {
+      table_[i] = table_[i % old];
+    }
+    for (std::size_t i = old / 4; old != 0 && i < words / 4; ++i) {
+      doorkeeper_[i] = doorkeeper_[i % (old / 4)];
+    }
+    sample_ = words * 20;                  // 10 accesses per key
+  }
+
+  // Record an access
+  void increment(std::size_t hash) {
+    if (table_.empty()) {
+      ensure_capacity(0);
+    }
+    if (++additions_ >= sample_) {
+      reset();
+    }
+    if (!doorkeeper_set(hash)) {
+      return;     // First sighting
+    }
+    for (unsigned i = 0; i < DEPTH; ++i) {
+      std::size_t word, shift;
+      locate(hash, i, word, shift);
+      if (((table_[word] >> shift) & 0xF) != 0xF) {
+        table_[word] += uint64_t(1) << shift;
+      }
+    }
+  }
+
+  // Estimated accesses since the counts were last halved
+  unsigned estimate(std::size_t hash) const {
+    if (table_.empty() || !doorkeeper_test(hash)) {
+      return 0;
+    }
+    unsigned count = 0xF;
+    for (unsigned i = 0; i < DEPTH; ++i) {
+      std::size_t word, shift;
+      locate(hash, i, word, shift);
+      count = std::min<unsigned>(count, (table_[word] >> shift) & 0xF);
+    }
+    return count + 1;
+  }
+
+  std::size_t memory_bytes() const {
+    return (table_.capacity() + doorkeeper_.capacity()) * sizeof(uint64_t);
+  }
+  uint64_t resets() const { return resets_; }
+
+ private:
+  static constexpr unsigned DEPTH = 4;
+
+  // A well-mixed 64-bit value for row i of the key's hash
+  static uint64_t rehash(std::size_t hash, unsigned i) {
+    uint64_t x = hash + (i + 1) * 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  void locate(std::size_t hash, unsigned i, std::size_t& word, std::size_t& shift) const {
+    uint64_t x = rehash(hash, i);
+    word = x & (table_.size() - 1);
+    shift = (x >> 60) * 4;
+  }
+
+  // Halve every counter; clear the doorkeeper
+  void reset() {
+    for (uint64_t& word : table_) {
+      word = (word >> 1) & 0x7777777777777777ULL;
+    }
+    std::fill(doorkeeper_.begin(), doorkeeper_.end(), 0);
+    additions_ = 0;
+    ++resets_;
+  }
+
+  // The doorkeeper uses two bits per key, from the hash's two halves
+  bool doorkeeper_test(std::size_t hash) const {
+    std::size_t mask = doorkeeper_.size() * 64 - 1;
+    std::size_t a = hash & mask, b = (hash >> 32 | hash << 32) & mask;
+    return (doorkeeper_[a / 64] >> (a % 64) & 1) && (doorkeeper_[b / 64] >> (b % 64) & 1);
+  }
+  // Sets the key's bits; returns whether they were all set already
+  bool doorkeeper_set(std::size_t hash) {
+    bool present = doorkeeper_test(hash);
+    std::size_t mask = doorkeeper_.size() * 64 - 1;
+    std::size_t a = hash & mask, b = (hash >> 32 | hash << 32) & mask;
+    doorkeeper_[a / 64] |= uint64_t(1) << (a % 64);
+    doorkeeper_[b / 64] |= uint64_t(1) << (b % 64);
+    return present;
+  }
+
+  std::vector<uint64_t> table_;
+  std::vector<uint64_t> doorkeeper_;
+  uint64_t sample_ = 0;
+  uint64_t additions_ = 0;
+  uint64_t resets_ = 0;
+};
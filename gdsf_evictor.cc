@@ -0,0 +1,170 @@
+/*
+ * Implementation of the GDSF_Evictor declared in gdsf_evictor.hh.
+ */
+
+#include "gdsf_evictor.hh"
+#include <algorithm>
+
+void
+GDSF_Evictor::place(uint32_t pos, Heap_Entry entry)
+{
+    heap_[pos] = entry;
+    nodes_[entry.node].heap_pos = pos;
+}
+
+void
+GDSF_Evictor::sift_up(uint32_t pos)
+{
+    Heap_Entry entry = heap_[pos];
+    while (pos > 0) {
+        uint32_t parent = (pos - 1) / 2;
+        if (heap_[parent].priority <= entry.priority) {
+            break;
+        }
+        place(pos, heap_[parent]);
+        pos = parent;
+    }
+    place(pos, entry);
+}
+
+void
+GDSF_Evictor::sift_down(uint32_t pos)
+{
+    Heap_Entry entry = heap_[pos];
+    uint32_t count = static_cast<uint32_t>(heap_.size());
+    for (;;) {
+        uint32_t child = 2 * pos + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && heap_[child + 1].priority < heap_[child].priority) {
+            ++child;
+        }
+        if (entry.priority <= heap_[child].priority) {
+            break;
+        }
+        place(pos, heap_[child]);
+        pos = child;
+    }
+    place(pos, entry);
+}
+
+void
+GDSF_Evictor::touch(const key_type& key, uint64_t size, double cost, bool sized)
+{
+    std::size_t hash = nodes_.hash(key);
+    uint32_t n = nodes_.find(key, hash);
+    bool added = n == NIL;
+    if (added) {
+        n = nodes_.insert(key, hash);
+        Node& node = nodes_[n];
+        node.size = 1;
+        node.cost = 1;
+        node.frequency = 0;
+        node.heap_pos = static_cast<uint32_t>(heap_.size());
+        heap_.push_back(Heap_Entry{ 0, n });
+    }
+    Node& node = nodes_[n];
+    if (sized) {
+        node.size = std::max<uint64_t>(size, 1);
+        node.cost = cost;
+    }
+    if (node.frequency < UINT32_MAX) {
+        ++node.frequency;
+    }
+
+    // A touched key's priority can only go down if it got bigger or cheaper
+    uint32_t pos = node.heap_pos;
+    double old_priority = heap_[pos].priority;
+    heap_[pos].priority = inflation_ + node.frequency * node.cost / node.size;
+    if (added || heap_[pos].priority < old_priority) {
+        sift_up(pos);
+    }
+    else {
+        sift_down(pos);
+    }
+}
+
+void
+GDSF_Evictor::touch_key(const key_type& key)
+{
+    touch(key, 0, 0, false);
+}
+
+void
+GDSF_Evictor::touch_key_sized(const key_type& key, uint64_t size, double cost)
+{
+    touch(key, size, cost, true);
+}
+
+void
+GDSF_Evictor::remove_at(uint32_t pos)
+// Fills the gap with the last entry and restores the heap around it
+{
+    Heap_Entry last = heap_.back();
+    heap_.pop_back();
+    if (pos == heap_.size()) {
+        return;
+    }
+    double removed = heap_[pos].priority;
+    place(pos, last);
+    if (last.priority < removed) {
+        sift_up(pos);
+    }
+    else {
+        sift_down(pos);
+    }
+}
+
+const key_type
+GDSF_Evictor::evict()
+// Lowest priority first; L rises to it
+{
+    if (heap_.empty()) {
+        return "";
+    }
+    Heap_Entry victim = heap_.front();
+    remove_at(0);
+    inflation_ = victim.priority;
+    key_type k = nodes_[victim.node].key;
+    nodes_.erase(victim.node);
+    return k;
+}
+
+const key_type
+GDSF_Evictor::peek_victim()
+{
+    return heap_.empty() ? "" : nodes_[heap_.front().node].key;
+}
+
+void
+GDSF_Evictor::forget_key(const key_type& key)
+// L stays: it only moves on evictions
+{
+    uint32_t n = nodes_.find(key, nodes_.hash(key));
+    if (n != NIL) {
+        remove_at(nodes_[n].heap_pos);
+        nodes_.erase(n);
+    }
+}
+
+void
+GDSF_Evictor::clear()
+{
+    nodes_.clear();
+    heap_.clear();
+    inflation_ = 0;
+}
+
+double
+GDSF_Evictor::priority(const key_type& key) const
+{
+    uint32_t n = nodes_.find(key, nodes_.hash(key));
+    return n == NIL ? 0 : heap_[nodes_[n].heap_pos].priority;
+}
+
+std::map<std::string, double>
+GDSF_Evictor::stats() const
+{
+    return { { "gdsf_inflation", inflation_ } };
+}
@@ -0,0 +1,81 @@
+/*
+ * Declarations for a GDSF (Greedy-Dual-Size-Frequency) eviction policy according to the pattern in evictor.hh.
+ * Implemented in gdsf_evictor.cc.
+ *
+ * GDSF (Cherkasova, 1998) gives every key the priority
+ *
+ *     H = L + frequency * cost / size
+ *
+ * and evicts the key with the lowest H. L, the inflation value, starts at 0
+ * and rises to the H of each victim, so keys that stop being used fall
+ * behind newly touched ones: it ages the frequencies without a pass over
+ * the keys. Dividing by size makes one large value worth less than the many
+ * small ones it displaces, which maximizes hits per byte of cache.
+ *
+ * Sizes come from touch_key_sized(). A plain touch_key() keeps the size and
+ * cost the key was last touched with, or counts 1 byte for a new key.
+ * Priorities live in a binary min-heap that each node knows its position
+ * in, so touch and evict are O(log n).
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "evictor.hh"
+#include "key_table.hh"
+
+class GDSF_Evictor final : public Evictor {
+private:
+    struct Node {
+        key_type key;
+        std::size_t hash;
+        uint64_t size;
+        double cost;
+        uint32_t frequency;
+        uint32_t heap_pos;
+    };
+    using Table = Key_Table<Node>;
+    static constexpr uint32_t NIL = Table::NIL;
+
+    // The priority is kept in the heap itself, next to the node it belongs to,
+    // so sifting doesn't touch the nodes except to update their positions.
+    struct Heap_Entry {
+        double priority;
+        uint32_t node;
+    };
+
+    Table nodes_;
+    std::vector<Heap_Entry> heap_;
+    double inflation_ = 0;      // L
+
+    void touch(const key_type& key, uint64_t size, double cost, bool sized);
+    void sift_up(uint32_t pos);
+    void sift_down(uint32_t pos);
+    void place(uint32_t pos, Heap_Entry entry);
+    void remove_at(uint32_t pos);
+
+public:
+    GDSF_Evictor() = default;
+    GDSF_Evictor(const GDSF_Evictor&) = delete;
+    GDSF_Evictor& operator=(const GDSF_Evictor&) = delete;
+
+    void touch_key(const key_type&) override;
+    void touch_key_sized(const key_type&, uint64_t size, double cost) override;
+    const key_type evict() override;
+    const key_type peek_victim() override;
+    bool empty() const override { return size() == 0; }
+    uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                         std::vector<key_type>& victims) override {
+        return evict_bytes_of(*this, bytes, size_of, victims);
+    }
+    void forget_key(const key_type&) override;
+    void clear() override;
+
+    // The inflation value L
+    std::map<std::string, double> stats() const override;
+
+    // Number of keys tracked, and a key's priority (0 if not tracked)
+    std::size_t size() const { return nodes_.size(); }
+    double priority(const key_type& key) const;
+};
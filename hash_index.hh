@@ -0,0 +1,400 @@
+/*
+ * Open-addressing hash index from keys to a small record, used by
+ * BasicCache (see "basic_cache.hh") in place of std::unordered_map.
+ *
+ * Laid out like Abseil's "Swiss table": every slot has one control byte that
+ * is either empty, deleted, or the low 7 bits of the key's hash. Lookups
+ * compare a whole group of 16 control bytes against those 7 bits at once
+ * (with SSE2 where available), so a probe touches one cache line of control
+ * bytes and only looks at slots whose bits match. Each slot also keeps the
+ * full hash, which is checked before the key itself, so false matches almost
+ * never cost a string compare, and growing never calls the hasher.
+ *
+ * Growing is incremental. When the table fills up, a bigger one is allocated
+ * and the old one is kept; every insert and erase then moves a fixed number
+ * of old slots across, and lookups check both tables until the old one is
+ * empty. So no single operation pays for moving the whole index.
+ *
+ * The <key, value> pairs live in separately allocated nodes that never move,
+ * so pointers to them stay valid until they are erased (BasicCache hands
+ * them to the slab allocator as owner cookies). Lookups don't modify anything
+ * and may run concurrently with each other, but not with insert or erase.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "evictor.hh"
+#include "fast_hash.hh"
+
+template <class Mapped, class Hasher = Fast_Hash>
+class Hash_Index {
+ public:
+  using value_type = std::pair<const key_type, Mapped>;
+
+  // Open addressing can't go past one entry per slot, and gets slow well
+  // before that, so larger load factors are capped here.
+  static constexpr float MAX_LOAD_FACTOR = 0.875;
+
+  // Old slots moved to the new table by each insert or erase while growing.
+  // A table only grows once it's full, and the new one is at least twice as
+  // big, so this finishes long before the new table could fill up in turn.
+  static constexpr std::size_t MIGRATE_STEP = 64;
+
+  // hasher: any callable taking a std::string_view and returning a std::size_t. It is
+  // stored by value, so a stateless hasher costs nothing and inlines.
+  explicit Hash_Index(Hasher hasher = Hasher(), float max_load_factor = 0.75)
+    : hasher_(std::move(hasher)) {
+    this->max_load_factor(max_load_factor);
+  }
+  ~Hash_Index() { clear(); }
+
+  Hash_Index(const Hash_Index&) = delete;
+  Hash_Index& operator=(const Hash_Index&) = delete;
+
+  void max_load_factor(float factor) {
+    assert(factor > 0 && "Load factor must be positive");
+    max_load_ = factor < MAX_LOAD_FACTOR ? factor : MAX_LOAD_FACTOR;
+  }
+  float max_load_factor() const { return max_load_; }
+
+  // Hash of key, as passed to the find/insert overloads that take one.
+  std::size_t hash(std::string_view key) const {
+    std::size_t h = hasher_(key);
+    // The control byte and the probe start both come from this, so spread a
+    // weak user hash over all the bits first
+    return (h ^ (h >> 32)) * 0x9e3779b97f4a7c15ULL;
+  }
+
+  // Entry for key, or nullptr.
+  // Takes a string_view, so callers needn't build a key_type to look one up.
+  value_type* find(std::string_view key) const { return find(key, hash(key)); }
+  value_type* find(std::string_view key, std::size_t h) const {
+    std::size_t index = table_.find(key, h);
+    if (index != Table::NOT_FOUND) {
+      return table_.slots[index].node;
+    }
+    // Keys not migrated yet are still in the old table
+    index = old_.find(key, h);
+    return index == Table::NOT_FOUND ? nullptr : old_.slots[index].node;
+  }
+
+  // Add key, which must not be present yet. The returned node stays put
+  // until erased.
+  value_type* insert(key_type&& key, Mapped mapped) {
+    std::size_t h = hash(key);
+    return insert(std::move(key), std::move(mapped), h);
+  }
+  value_type* insert(key_type&& key, Mapped mapped, std::size_t h) {
+    assert(find(key, h) == nullptr && "Key is already in the index");
+    migrate(MIGRATE_STEP);
+    if (table_.size + table_.deleted + 1 > max_fill(table_.capacity)) {
+      grow();
+    }
+    value_type* node = new value_type(std::move(key), std::move(mapped));
+    table_.add(h, node);
+    return node;
+  }
+
+  // Remove an entry obtained from find() or insert(), and free its node.
+  void erase(value_type* node) {
+    std::size_t h = hash(node->first);
+    std::size_t index = table_.find(node, h);
+    if (index != Table::NOT_FOUND) {
+      table_.erase_slot(index);
+    }
+    else {
+      index = old_.find(node, h);
+      assert(index != Table::NOT_FOUND && "Erasing a node that isn't in the index");
+      old_.erase_slot(index);
+    }
+    delete node;
+    migrate(MIGRATE_STEP);
+  }
+
+  // Call f(value_type&) on every entry, in no particular order.
+  template <class F>
+  void for_each(F f) {
+    old_.for_each(f);
+    table_.for_each(f);
+  }
+  // Same, calling f(const value_type&)
+  template <class F>
+  void for_each(F f) const {
+    auto visit = [&f](const value_type& node) { f(node); };
+    old_.for_each(visit);
+    table_.for_each(visit);
+  }
+
+  // Remove every entry and give back the tables.
+  void clear() {
+    for_each([](value_type& node) { delete &node; });
+    table_ = Table();
+    old_ = Table();
+    migrate_pos_ = 0;
+  }
+
+  std::size_t size() const { return table_.size + old_.size; }
+  bool empty() const { return size() == 0; }
+  std::size_t capacity() const { return table_.capacity; }
+
+  // Old-table slots still to be looked at before the current resize is
+  // done (0 when not resizing), and the number of resizes started so far.
+  std::size_t rehash_pending() const { return old_.capacity - migrate_pos_; }
+  std::size_t rehashes() const { return rehashes_; }
+
+  // Bytes held by the tables themselves (not the nodes).
+  std::size_t table_bytes() const { return table_.bytes() + old_.bytes(); }
+
+  // Share of the table one entry accounts for when the index is at its
+  // maximum load: its slot and control byte, over the load factor.
+  std::size_t slot_bytes() const {
+    return static_cast<std::size_t>((sizeof(Slot) + 1) / max_load_ + 0.5);
+  }
+
+ private:
+  static constexpr std::size_t GROUP_WIDTH = 16;
+
+  // Control byte values. Full slots hold 7 hash bits, so the high bit is clear.
+  static constexpr int8_t EMPTY = -128;   // 0x80
+  static constexpr int8_t DELETED = -2;   // 0xFE
+
+  struct Slot {
+    std::size_t hash;
+    value_type* node;
+  };
+
+  static bool is_full(int8_t ctrl) { return ctrl >= 0; }
+  static int8_t h2(std::size_t h) { return static_cast<int8_t>(h & 0x7F); }
+  static std::size_t h1(std::size_t h) { return h >> 7; }
+
+  static uint32_t trailing_zeros(uint32_t bits) { return __builtin_ctz(bits); }
+  static uint32_t leading_zeros16(uint32_t bits) { return __builtin_clz(bits) - 16; }
+
+  // Sixteen consecutive control bytes, each query giving one bit per byte.
+  struct Group {
+#ifdef __SSE2__
+    __m128i ctrl;
+    explicit Group(const int8_t* pos)
+      : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+    uint32_t match(int8_t h) const {
+      return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), ctrl));
+    }
+    uint32_t match_empty() const {
+      return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(EMPTY), ctrl));
+    }
+    // Empty and deleted both have the high bit set
+    uint32_t match_free() const { return _mm_movemask_epi8(ctrl); }
+#else
+    const int8_t* ctrl;
+    explicit Group(const int8_t* pos) : ctrl(pos) {}
+    uint32_t match(int8_t h) const {
+      uint32_t bits = 0;
+      for (std::size_t i = 0; i < GROUP_WIDTH; ++i) bits |= uint32_t(ctrl[i] == h) << i;
+      return bits;
+    }
+    uint32_t match_empty() const { return match(EMPTY); }
+    uint32_t match_free() const {
+      uint32_t bits = 0;
+      for (std::size_t i = 0; i < GROUP_WIDTH; ++i) bits |= uint32_t(ctrl[i] < 0) << i;
+      return bits;
+    }
+#endif
+  };
+
+  // Triangular probing over group-sized steps. With a power-of-two capacity
+  // this visits every group before repeating one.
+  struct Probe {
+    std::size_t offset, mask, step = 0;
+    Probe(std::size_t h, std::size_t m) : offset(h1(h) & m), mask(m) {}
+    void next() {
+      step += GROUP_WIDTH;
+      offset = (offset + step) & mask;
+    }
+  };
+
+  // One array of control bytes and slots. While growing there are two.
+  struct Table {
+    static constexpr std::size_t NOT_FOUND = SIZE_MAX;
+
+    std::unique_ptr<int8_t[]> ctrl;
+    std::unique_ptr<Slot[]> slots;
+    std::size_t capacity = 0;  // Always 0 or a power of two >= GROUP_WIDTH
+    std::size_t mask = 0;
+    std::size_t size = 0;
+    std::size_t deleted = 0;   // Tombstones
+
+    Table() = default;
+    explicit Table(std::size_t cap)
+      : ctrl(new int8_t[cap + GROUP_WIDTH]), slots(new Slot[cap]),
+        capacity(cap), mask(cap - 1) {
+      std::memset(ctrl.get(), EMPTY, cap + GROUP_WIDTH);
+    }
+
+    std::size_t bytes() const {
+      return capacity == 0 ? 0 : capacity * sizeof(Slot) + capacity + GROUP_WIDTH;
+    }
+
+    // Slot index holding key (or node, for the overload taking one).
+    std::size_t find(std::string_view key, std::size_t h) const {
+      return probe(h, [&](const Slot& slot) { return slot.hash == h && slot.node->first == key; });
+    }
+    std::size_t find(const value_type* node, std::size_t h) const {
+      return probe(h, [&](const Slot& slot) { return slot.node == node; });
+    }
+
+    template <class Match>
+    std::size_t probe(std::size_t h, Match matches) const {
+      if (size == 0) {
+        return NOT_FOUND;
+      }
+      Probe probe(h, mask);
+      while (true) {
+        Group group(ctrl.get() + probe.offset);
+        for (uint32_t bits = group.match(h2(h)); bits != 0; bits &= bits - 1) {
+          std::size_t index = (probe.offset + trailing_zeros(bits)) & mask;
+          if (matches(slots[index])) {
+            return index;
+          }
+        }
+        if (group.match_empty() != 0) {
+          return NOT_FOUND;
+        }
+        probe.next();
+      }
+    }
+
+    // The caller makes sure there is room.
+    void add(std::size_t h, value_type* node) {
+      Probe probe(h, mask);
+      uint32_t bits;
+      while ((bits = Group(ctrl.get() + probe.offset).match_free()) == 0) {
+        probe.next();
+      }
+      std::size_t index = (probe.offset + trailing_zeros(bits)) & mask;
+      if (ctrl[index] == DELETED) {
+        --deleted;
+      }
+      set_ctrl(index, h2(h));
+      slots[index] = Slot{ h, node };
+      ++size;
+    }
+
+    // The first GROUP_WIDTH control bytes are mirrored after the last one, so
+    // a group read starting near the end needn't wrap.
+    void set_ctrl(std::size_t index, int8_t value) {
+      ctrl[index] = value;
+      ctrl[((index - GROUP_WIDTH) & mask) + GROUP_WIDTH] = value;
+    }
+
+    void erase_slot(std::size_t index) {
+      --size;
+      // If no group containing this slot was ever full, no probe went past it
+      // and it can go straight back to empty instead of leaving a tombstone.
+      uint32_t empty_after = Group(ctrl.get() + index).match_empty();
+      uint32_t empty_before = Group(ctrl.get() + ((index - GROUP_WIDTH) & mask)).match_empty();
+      bool never_full = empty_before != 0 && empty_after != 0 &&
+                        trailing_zeros(empty_after) + leading_zeros16(empty_before) < GROUP_WIDTH;
+      if (never_full) {
+        set_ctrl(index, EMPTY);
+      }
+      else {
+        set_ctrl(index, DELETED);
+        ++deleted;
+      }
+    }
+
+    template <class F>
+    void for_each(F& f) const {
+      for (std::size_t i = 0; i < capacity; ++i) {
+        if (is_full(ctrl[i])) {
+          f(*slots[i].node);
+        }
+      }
+    }
+  };
+
+  std::size_t max_fill(std::size_t capacity) const {
+    return static_cast<std::size_t>(capacity * max_load_);
+  }
+
+  // Start moving everything into a new table: the same size if it's mostly
+  // tombstones, bigger otherwise.
+  void grow() {
+    std::size_t live = size();
+    std::size_t capacity = table_.capacity;
+    if (capacity == 0 || old_.capacity != 0 || live + 1 > max_fill(capacity) / 2) {
+      capacity = capacity == 0 ? GROUP_WIDTH : capacity * 2;
+      while (live + 1 > max_fill(capacity)) {
+        capacity *= 2;
+      }
+    }
+    Table next(capacity);
+    ++rehashes_;
+    if (old_.capacity != 0) {
+      // Rare: inserts outran the migration (tiny load factors), so there's
+      // no third table to spill into. Move everything now.
+      for (Table* from : { &old_, &table_ }) {
+        for (std::size_t i = 0; i < from->capacity; ++i) {
+          if (is_full(from->ctrl[i])) {
+            next.add(from->slots[i].hash, from->slots[i].node);
+          }
+        }
+      }
+      old_ = Table();
+      table_ = std::move(next);
+      migrate_pos_ = 0;
+      return;
+    }
+    old_ = std::move(table_);
+    table_ = std::move(next);
+    migrate_pos_ = 0;
+    migrate(MIGRATE_STEP);
+  }
+
+  // Move up to 'slots' old slots to the current table, but never past its
+  // load limit. Moved slots become tombstones so the old table's remaining
+  // probe chains stay intact.
+  void migrate(std::size_t slots) {
+    if (old_.capacity == 0) {
+      return;
+    }
+    std::size_t end = std::min(old_.capacity, migrate_pos_ + slots);
+    for (; migrate_pos_ < end && old_.size > 0; ++migrate_pos_) {
+      if (!is_full(old_.ctrl[migrate_pos_])) {
+        continue;
+      }
+      if (table_.size + table_.deleted + 1 > max_fill(table_.capacity)) {
+        return;
+      }
+      const Slot& slot = old_.slots[migrate_pos_];
+      table_.add(slot.hash, slot.node);
+      old_.set_ctrl(migrate_pos_, DELETED);
+      --old_.size;
+    }
+    if (old_.size == 0) {
+      old_ = Table();
+      migrate_pos_ = 0;
+    }
+  }
+
+  Hasher hasher_;
+  float max_load_ = 0.75;
+  Table table_;
+  Table old_;                    // Being emptied into table_, if capacity != 0
+  std::size_t migrate_pos_ = 0;  // Next slot of old_ to move
+  std::size_t rehashes_ = 0;
+};
@@ -0,0 +1,109 @@
+/*
+ * A counting Bloom filter of the keys in a cache, readable without a lock.
+ *
+ * Each key bumps PROBES 4-bit counters, packed 16 to an atomic 64-bit word.
+ * A key whose counters aren't all nonzero was never added (or has been
+ * removed), so a lookup for it can be answered as a miss straight away; a
+ * key that passes is probably present, and has to be looked up for real.
+ * Removing a key decrements its counters again. A counter that reaches 15
+ * stays there, since it can no longer tell how many keys share it, so
+ * removal never makes the filter forget a key that is still present.
+ *
+ * Sized for a number of keys at 8 to 16 counters (4 to 8 bytes) each, for a
+ * false-positive rate of about 1 to 3% when full. Past that it fills up
+ * and the rate climbs, so the owner should build a bigger one.
+ *
+ * Only one thread may change the filter at a time, but any number may call
+ * may_contain() meanwhile: a reader racing an add or remove sees the key
+ * either way, as if it ran just before or just after. Keys are given by
+ * their hash.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class Key_Filter {
+ public:
+  explicit Key_Filter(std::size_t keys) {
+    std::size_t counters = 64;
+    while (counters < keys * 8) {
+      counters *= 2;
+    }
+    mask_ = counters - 1;
+    capacity_ = counters / 8;
+    words_ = counters / 16;
+    table_.reset(new std::atomic<uint64_t>[words_]());
+  }
+
+  Key_Filter(const Key_Filter&) = delete;
+  Key_Filter& operator=(const Key_Filter&) = delete;
+
+  // Keys it is sized for
+  std::size_t capacity() const { return capacity_; }
+
+  void add(std::size_t hash) {
+    for (unsigned i = 0; i < PROBES; ++i) {
+      std::size_t word, shift;
+      locate(hash, i, word, shift);
+      uint64_t bits = table_[word].load(std::memory_order_relaxed);
+      if (((bits >> shift) & 0xF) != 0xF) {
+        table_[word].store(bits + (uint64_t(1) << shift), std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Take back an add() of the same hash
+  void remove(std::size_t hash) {
+    for (unsigned i = 0; i < PROBES; ++i) {
+      std::size_t word, shift;
+      locate(hash, i, word, shift);
+      uint64_t bits = table_[word].load(std::memory_order_relaxed);
+      uint64_t count = (bits >> shift) & 0xF;
+      if (count != 0xF && count != 0) {
+        table_[word].store(bits - (uint64_t(1) << shift), std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // False only if no key with this hash is in the filter
+  bool may_contain(std::size_t hash) const {
+    for (unsigned i = 0; i < PROBES; ++i) {
+      std::size_t word, shift;
+      locate(hash, i, word, shift);
+      if (((table_[word].load(std::memory_order_relaxed) >> shift) & 0xF) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void clear() {
+    for (std::size_t i = 0; i < words_; ++i) {
+      table_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  std::size_t memory_bytes() const { return words_ * sizeof(uint64_t); }
+
+ private:
+  static constexpr unsigned PROBES = 3;
+
+  // Word and bit offset of the i-th counter for a hash, by double hashing
+  // over a remix of it (the index uses the hash's own bits already)
+  void locate(std::size_t hash, unsigned i, std::size_t& word, std::size_t& shift) const {
+    uint64_t h = (hash ^ (hash >> 31)) * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 29;
+    uint64_t counter = (h + i * ((h >> 32) | 1)) & mask_;
+    word = counter / 16;
+    shift = (counter % 16) * 4;
+  }
+
+  std::unique_ptr<std::atomic<uint64_t>[]> table_;
+  std::size_t words_;
+  std::size_t capacity_;
+  uint64_t mask_;
+};
@@ -0,0 +1,202 @@
+/*
+ * Flat storage for an evictor's per-key records, shared by the evictors.
+ *
+ * Records (Nodes) live in one array and are named by their 32-bit index, so
+ * evictors link them into lists or rings with plain integers. Keys are found
+ * through an open-addressing table of indices into that array, probed
+ * linearly and kept at most half full. Erased records are recycled with their
+ * key strings, so once the array has grown to the working set, inserting a
+ * key allocates nothing (beyond what a long key's string needs).
+ *
+ * Node must be default constructible and movable, with members 'key' (a Key)
+ * and 'hash' (std::size_t), which the table fills in. Key is normally the
+ * key string; tables that only need to recognise keys, such as ARC's ghost
+ * lists, can store the hash alone as the Key.
+ *
+ * find() only reads, so it may run on several threads at once as long as
+ * nothing is inserted or erased meanwhile.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "evictor.hh"
+#include "fast_hash.hh"
+
+template <class Node, class Key = key_type>
+class Key_Table {
+ public:
+  static constexpr uint32_t NIL = UINT32_MAX;
+
+  std::size_t hash(const key_type& key) const { return hasher_(key); }
+
+  // Index of key's record, or NIL.
+  uint32_t find(const Key& key, std::size_t hash) const {
+    if (slots_.empty()) {
+      return NIL;
+    }
+    return slots_[find_slot(key, hash)];
+  }
+
+  // Add a record for key, which must not be present yet, and return its index.
+  // Its other members hold whatever the recycled record had.
+  uint32_t insert(const Key& key, std::size_t hash) {
+    if ((size_ + 1) * 2 > slots_.size()) {
+      grow();
+    }
+    uint32_t n;
+    if (!free_.empty()) {
+      n = free_.back();
+      free_.pop_back();
+      nodes_[n].key = key;    // Reuses the recycled string's buffer
+    }
+    else {
+      assert(nodes_.size() < NIL && "Too many keys for 32-bit node indices");
+      n = static_cast<uint32_t>(nodes_.size());
+      nodes_.emplace_back();
+      nodes_[n].key = key;
+    }
+    nodes_[n].hash = hash;
+    std::size_t slot = find_slot(key, hash);
+    assert(slots_[slot] == NIL && "Key is already present");
+    slots_[slot] = n;
+    ++size_;
+    return n;
+  }
+
+  // Forget record n. Its index may be handed out again by insert().
+  void erase(uint32_t n) {
+    std::size_t mask = slots_.size() - 1;
+    std::size_t slot = nodes_[n].hash & mask;
+    while (slots_[slot] != n) {
+      slot = (slot + 1) & mask;
+    }
+    erase_slot(slot);
+    free_.push_back(n);
+    --size_;
+  }
+
+  // Forget every record
+  void clear() {
+    nodes_.clear();
+    slots_.clear();
+    free_.clear();
+    size_ = 0;
+  }
+
+  Node& operator[](uint32_t n) { return nodes_[n]; }
+  const Node& operator[](uint32_t n) const { return nodes_[n]; }
+
+  // Live records
+  std::size_t size() const { return size_; }
+  // Length of the record array, live or not: indices are below this.
+  std::size_t extent() const { return nodes_.size(); }
+  // Bytes held by the table's arrays. Keys too long for a string's inline
+  // buffer own a heap block besides, which this leaves out.
+  std::size_t memory_bytes() const {
+    return nodes_.capacity() * sizeof(Node)
+        + (slots_.capacity() + free_.capacity()) * sizeof(uint32_t);
+  }
+
+ private:
+  // The slot holding key's record, or the empty slot where it would go
+  std::size_t find_slot(const Key& key, std::size_t hash) const {
+    std::size_t mask = slots_.size() - 1;
+    std::size_t i = hash & mask;
+    while (slots_[i] != NIL) {
+      const Node& node = nodes_[slots_[i]];
+      if (node.hash == hash && node.key == key) {
+        break;
+      }
+      i = (i + 1) & mask;
+    }
+    return i;
+  }
+
+  // Backward-shift deletion: pull later entries of the probe run into the
+  // hole, so lookups never have to step over tombstones.
+  void erase_slot(std::size_t slot) {
+    std::size_t mask = slots_.size() - 1;
+    std::size_t hole = slot;
+    for (std::size_t i = (slot + 1) & mask; slots_[i] != NIL; i = (i + 1) & mask) {
+      std::size_t home = nodes_[slots_[i]].hash & mask;
+      // Entry at i may move to the hole unless its home lies in (hole, i]
+      bool stays = (hole <= i) ? (hole < home && home <= i) : (hole < home || home <= i);
+      if (!stays) {
+        slots_[hole] = slots_[i];
+        hole = i;
+      }
+    }
+    slots_[hole] = NIL;
+  }
+
+  // Doubles the slot table
+  void grow() {
+    std::vector<uint32_t> old(std::max<std::size_t>(16, slots_.size() * 2), NIL);
+    old.swap(slots_);
+    std::size_t mask = slots_.size() - 1;
+    for (uint32_t n : old) {
+      if (n == NIL) {
+        continue;
+      }
+      std::size_t i = nodes_[n].hash & mask;
+      while (slots_[i] != NIL) {
+        i = (i + 1) & mask;
+      }
+      slots_[i] = n;
+    }
+  }
+
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> slots_;   // Record indices, NIL if empty; size is a power of two
+  std::vector<uint32_t> free_;    // Erased records
+  std::size_t size_ = 0;
+  Fast_Hash hasher_;
+};
+
+// A doubly linked list threaded through a Key_Table's records by index, for
+// evictors that keep keys in LRU or FIFO order. Records need uint32_t 'prev'
+// and 'next' members. head is the oldest end.
+struct Index_List {
+  static constexpr uint32_t NIL = UINT32_MAX;
+
+  uint32_t head = NIL;
+  uint32_t tail = NIL;
+  std::size_t size = 0;
+
+  bool empty() const { return head == NIL; }
+
+  template <class Table>
+  void push_back(Table& table, uint32_t n) {
+    auto& node = table[n];
+    node.prev = tail;
+    node.next = NIL;
+    if (tail == NIL) head = n;
+    else table[tail].next = n;
+    tail = n;
+    ++size;
+  }
+
+  template <class Table>
+  void unlink(Table& table, uint32_t n) {
+    auto& node = table[n];
+    if (node.prev == NIL) head = node.next;
+    else table[node.prev].next = node.next;
+    if (node.next == NIL) tail = node.prev;
+    else table[node.next].prev = node.prev;
+    --size;
+  }
+
+  // Unlink and return the oldest record
+  template <class Table>
+  uint32_t pop_front(Table& table) {
+    uint32_t n = head;
+    unlink(table, n);
+    return n;
+  }
+};
@@ -0,0 +1,181 @@
+/*
+ * Implementation of the LFU_Evictor declared in lfu_evictor.hh.
+ */
+
+#include "lfu_evictor.hh"
+#include <algorithm>
+#include <cassert>
+
+LFU_Evictor::LFU_Evictor(double aging_period)
+    : aging_period_(aging_period)
+{
+    assert(aging_period > 0 && "Aging period must be positive");
+}
+
+uint32_t
+LFU_Evictor::add_bucket(uint32_t count, uint32_t after)
+// Links an empty bucket in after 'after', or first if that's NIL
+{
+    uint32_t b;
+    if (!free_buckets_.empty()) {
+        b = free_buckets_.back();
+        free_buckets_.pop_back();
+    }
+    else {
+        b = static_cast<uint32_t>(buckets_.size());
+        buckets_.emplace_back();
+    }
+    Bucket& bucket = buckets_[b];
+    bucket.count = count;
+    bucket.keys = Index_List();
+    bucket.prev = after;
+    bucket.next = after == NIL ? lowest_ : buckets_[after].next;
+    if (bucket.next != NIL) buckets_[bucket.next].prev = b;
+    if (after == NIL) lowest_ = b;
+    else buckets_[after].next = b;
+    return b;
+}
+
+void
+LFU_Evictor::drop_bucket_if_empty(uint32_t b)
+{
+    Bucket& bucket = buckets_[b];
+    if (!bucket.keys.empty()) {
+        return;
+    }
+    if (bucket.prev == NIL) lowest_ = bucket.next;
+    else buckets_[bucket.prev].next = bucket.next;
+    if (bucket.next != NIL) buckets_[bucket.next].prev = bucket.prev;
+    free_buckets_.push_back(b);
+}
+
+void
+LFU_Evictor::place(uint32_t n, uint32_t b)
+{
+    nodes_[n].bucket = b;
+    buckets_[b].keys.push_back(nodes_, n);
+}
+
+void
+LFU_Evictor::age()
+// Halves every count, merging buckets that end up with the same one. Counts
+// keep their order, so each key stays behind those that were less used.
+{
+    touches_ = 0;
+    ++agings_;
+    uint32_t kept = NIL;
+    for (uint32_t b = lowest_; b != NIL; ) {
+        uint32_t next = buckets_[b].next;
+        uint32_t count = std::max<uint32_t>(1, buckets_[b].count / 2);
+        if (kept != NIL && buckets_[kept].count == count) {
+            Index_List& keys = buckets_[b].keys;
+            while (!keys.empty()) {
+                place(keys.pop_front(nodes_), kept);
+            }
+            drop_bucket_if_empty(b);
+        }
+        else {
+            buckets_[b].count = count;
+            kept = b;
+        }
+        b = next;
+    }
+}
+
+void
+LFU_Evictor::touch_key(const key_type& key)
+// New keys start with a count of 1; known keys move up one count
+{
+    std::size_t hash = nodes_.hash(key);
+    uint32_t n = nodes_.find(key, hash);
+    if (n == NIL) {
+        uint32_t b = lowest_;
+        if (b == NIL || buckets_[b].count != 1) {
+            b = add_bucket(1, NIL);
+        }
+        place(nodes_.insert(key, hash), b);
+    }
+    else {
+        uint32_t b = nodes_[n].bucket;
+        uint32_t count = buckets_[b].count;
+        uint32_t next = count == UINT32_MAX ? b : buckets_[b].next;
+        if (next == NIL || (next != b && buckets_[next].count != count + 1)) {
+            next = add_bucket(count + 1, b);
+        }
+        buckets_[b].keys.unlink(nodes_, n);
+        place(n, next);
+        drop_bucket_if_empty(b);
+    }
+    if (++touches_ >= aging_period_ * nodes_.size()) {
+        age();
+    }
+}
+
+const key_type
+LFU_Evictor::evict()
+// Least used key, oldest arrival first among equals
+{
+    if (lowest_ == NIL) {
+        return "";
+    }
+    uint32_t b = lowest_;
+    uint32_t n = buckets_[b].keys.pop_front(nodes_);
+    key_type k = nodes_[n].key;
+    nodes_.erase(n);
+    drop_bucket_if_empty(b);
+    return k;
+}
+
+const key_type
+LFU_Evictor::peek_victim()
+{
+    return lowest_ == NIL ? "" : nodes_[buckets_[lowest_].keys.head].key;
+}
+
+void
+LFU_Evictor::forget_key(const key_type& key)
+{
+    uint32_t n = nodes_.find(key, nodes_.hash(key));
+    if (n != NIL) {
+        uint32_t b = nodes_[n].bucket;
+        buckets_[b].keys.unlink(nodes_, n);
+        nodes_.erase(n);
+        drop_bucket_if_empty(b);
+    }
+}
+
+void
+LFU_Evictor::clear()
+{
+    nodes_.clear();
+    buckets_.clear();
+    free_buckets_.clear();
+    lowest_ = NIL;
+    touches_ = 0;
+}
+
+uint32_t
+LFU_Evictor::count(const key_type& key) const
+{
+    uint32_t n = nodes_.find(key, nodes_.hash(key));
+    return n == NIL ? 0 : buckets_[nodes_[n].bucket].count;
+}
+
+std::size_t
+LFU_Evictor::memory_bytes() const
+{
+    return nodes_.memory_bytes() + buckets_.capacity() * sizeof(Bucket)
+        + free_buckets_.capacity() * sizeof(uint32_t);
+}
+
+std::map<std::string, double>
+LFU_Evictor::stats() const
+{
+    std::size_t buckets = buckets_.size() - free_buckets_.size();
+    double per_key = nodes_.size() ? double(memory_bytes()) / nodes_.size() : 0;
+    return {
+        { "lfu_buckets", double(buckets) },
+        { "lfu_agings", double(agings_) },
+        { "lfu_bytes_per_key", per_key },
+    };
+}
@@ -0,0 +1,86 @@
+/*
+ * Declarations for an LFU (Least Frequently Used) eviction policy according to the pattern in evictor.hh.
+ * Implemented in lfu_evictor.cc.
+ *
+ * Every operation is O(1), after Shah, Mitra and Matani, "An O(1) algorithm
+ * for implementing the LFU cache eviction scheme" (2010): keys with the same
+ * use count share a bucket, buckets form a list in increasing count order,
+ * and a touch moves its key to the next bucket along, creating it if
+ * needed. Victims come from the lowest bucket, least recently arrived first,
+ * so ties are broken by LRU.
+ *
+ * Counts alone would let keys that were hot once stay forever, so every
+ * aging_period * (tracked keys) touches all counts are halved. That pass is
+ * linear in the keys, but amortized over the touches that triggered it.
+ *
+ * Each key costs one Node (sizeof(Node) bytes, 56 on x86-64 with an inline
+ * key string) plus two to four 4-byte slots in the key table; memory_bytes()
+ * gives the total, and the "lfu_bytes_per_key" stat the average.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "evictor.hh"
+#include "key_table.hh"
+
+class LFU_Evictor final : public Evictor {
+private:
+    struct Node {
+        key_type key;
+        std::size_t hash;
+        uint32_t prev;      // Towards the oldest end of its bucket
+        uint32_t next;      // Towards the newest end
+        uint32_t bucket;
+    };
+    using Table = Key_Table<Node>;
+    static constexpr uint32_t NIL = Table::NIL;
+
+    struct Bucket {
+        uint32_t count;     // Uses of every key in it
+        uint32_t prev;      // Towards lower counts
+        uint32_t next;      // Towards higher counts
+        Index_List keys;    // Oldest arrival at the head
+    };
+
+    Table nodes_;
+    std::vector<Bucket> buckets_;
+    std::vector<uint32_t> free_buckets_;
+    uint32_t lowest_ = NIL;         // Bucket with the lowest count
+    double aging_period_;
+    uint64_t touches_ = 0;          // Since the last aging
+    uint64_t agings_ = 0;
+
+    uint32_t add_bucket(uint32_t count, uint32_t after);
+    void drop_bucket_if_empty(uint32_t b);
+    void place(uint32_t n, uint32_t b);
+    void age();
+
+public:
+    // aging_period: how many touches per tracked key between halvings of
+    // the counts. Larger keeps more history.
+    explicit LFU_Evictor(double aging_period = 16);
+    LFU_Evictor(const LFU_Evictor&) = delete;
+    LFU_Evictor& operator=(const LFU_Evictor&) = delete;
+
+    void touch_key(const key_type&) override;
+    const key_type evict() override;
+    const key_type peek_victim() override;
+    bool empty() const override { return size() == 0; }
+    uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                         std::vector<key_type>& victims) override {
+        return evict_bytes_of(*this, bytes, size_of, victims);
+    }
+    void forget_key(const key_type&) override;
+    void clear() override;
+
+    // Bucket count, agings so far and bytes per key
+    std::map<std::string, double> stats() const override;
+
+    // Number of keys tracked, a key's use count (0 if not tracked), and the
+    // bytes held for all of them
+    std::size_t size() const { return nodes_.size(); }
+    uint32_t count(const key_type& key) const;
+    std::size_t memory_bytes() const;
+};
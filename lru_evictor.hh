@@ -8,21 +8,46 @@
  */
 
 #pragma once
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
 #include "evictor.hh"
-#include "LList.hh"
-#include "cache.hh"
+#include "key_table.hh"
 
-class LRU_Evictor : public Evictor {
+// The recency list is intrusive and index-based: every key lives in one Node
+// of a Key_Table (see "key_table.hh"), linked to its neighbours by index.
+// Touching a known key only relinks its node, and evicted nodes are recycled,
+// so once the table has grown to the working set nothing is allocated.
+class LRU_Evictor final : public Evictor {
 private:
-    LList* LL_;
-    std::unordered_map<key_type, std::shared_ptr<Node>> map_;
+    struct Node {
+        key_type key;
+        std::size_t hash;
+        uint32_t prev;  // Towards the least recently used end
+        uint32_t next;  // Towards the most recently used end
+    };
+    using Table = Key_Table<Node>;
+    static constexpr uint32_t NIL = Table::NIL;
+
+    Table nodes_;
+    Index_List list_;   // Least recently used at the head
+
 public:
-    LRU_Evictor();
-    ~LRU_Evictor();
+    LRU_Evictor() = default;
+    ~LRU_Evictor() = default;
     LRU_Evictor(const LRU_Evictor&) = delete;
     LRU_Evictor& operator=(const LRU_Evictor&) = delete;
 
     void touch_key(const key_type&) override;
     const key_type evict() override;
-};
\ No newline at end of file
+    const key_type peek_victim() override;
+    bool empty() const override { return size() == 0; }
+    uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                         std::vector<key_type>& victims) override {
+        return evict_bytes_of(*this, bytes, size_of, victims);
+    }
+    void forget_key(const key_type&) override;
+    void clear() override;
+
+    // Number of keys currently tracked
+    std::size_t size() const { return nodes_.size(); }
+};
@@ -0,0 +1,166 @@
+/*
+ * Implementation of the S3FIFO_Evictor declared in s3fifo_evictor.hh.
+ */
+
+#include "s3fifo_evictor.hh"
+#include <cassert>
+
+S3FIFO_Evictor::S3FIFO_Evictor(double small_ratio)
+    : small_ratio_(small_ratio)
+{
+    assert(small_ratio >= 0 && small_ratio <= 1 && "Small queue share must be within [0, 1]");
+}
+
+void
+S3FIFO_Evictor::hit(const Node& node) const
+// Two racing readers may both store the same count; a lost hit only costs
+// a little frequency information
+{
+    uint8_t freq = node.freq.load(std::memory_order_relaxed);
+    if (freq < MAX_FREQ) {
+        node.freq.store(freq + 1, std::memory_order_relaxed);
+    }
+}
+
+void
+S3FIFO_Evictor::remember(std::size_t hash)
+// Adds a ghost for a key evicted from S. G holds as many keys as M may.
+{
+    // Two keys with the same hash share a ghost
+    if (ghosts_.find(hash, hash) == NIL) {
+        ghost_queue_.push_back(ghosts_, ghosts_.insert(hash, hash));
+    }
+    std::size_t limit = std::size_t(capacity_ * (1 - small_ratio_));
+    while (ghosts_.size() > limit) {
+        ghosts_.erase(ghost_queue_.pop_front(ghosts_));
+    }
+}
+
+void
+S3FIFO_Evictor::touch_key(const key_type& key)
+// New keys go to S, or to M if they were evicted from S recently
+{
+    std::size_t hash = resident_.hash(key);
+    uint32_t n = resident_.find(key, hash);
+    if (n != NIL) {
+        hit(resident_[n]);
+        return;
+    }
+    n = resident_.insert(key, hash);
+    resident_[n].freq.store(0, std::memory_order_relaxed);
+
+    uint32_t g = ghosts_.find(hash, hash);
+    if (g != NIL) {
+        ghost_queue_.unlink(ghosts_, g);
+        ghosts_.erase(g);
+        ++ghost_hits_;
+        main_.push_back(resident_, n);
+    }
+    else {
+        small_.push_back(resident_, n);
+    }
+    resident_[n].in_main = g != NIL;
+}
+
+void
+S3FIFO_Evictor::mark_key(const key_type& key) const
+{
+    uint32_t n = resident_.find(key, resident_.hash(key));
+    if (n != NIL) {
+        hit(resident_[n]);
+    }
+}
+
+uint32_t
+S3FIFO_Evictor::victim()
+// Looks at S while it is over its share (or M is empty), else at M, until
+// the head of that queue has no hits left, and leaves it there. Every key
+// passed over loses a hit or leaves S, so this ends.
+{
+    for (;;) {
+        if (!small_.empty() && (small_.size >= small_ratio_ * capacity_ || main_.empty())) {
+            uint32_t n = small_.head;
+            Node& node = resident_[n];
+            if (node.freq.load(std::memory_order_relaxed) == 0) {
+                return n;
+            }
+            // Hit while in S: promote
+            small_.pop_front(resident_);
+            node.freq.store(0, std::memory_order_relaxed);
+            node.in_main = true;
+            main_.push_back(resident_, n);
+            continue;
+        }
+
+        uint32_t n = main_.head;
+        Node& node = resident_[n];
+        uint8_t freq = node.freq.load(std::memory_order_relaxed);
+        if (freq == 0) {
+            return n;
+        }
+        main_.pop_front(resident_);
+        node.freq.store(freq - 1, std::memory_order_relaxed);
+        main_.push_back(resident_, n);
+    }
+}
+
+const key_type
+S3FIFO_Evictor::evict()
+// Keys evicted from S leave a ghost
+{
+    capacity_ = resident_.size();
+    if (capacity_ == 0) {
+        return "";
+    }
+    uint32_t n = victim();
+    Node& node = resident_[n];
+    key_type k = node.key;
+    std::size_t hash = node.hash;
+    bool in_main = node.in_main;
+    (in_main ? main_ : small_).unlink(resident_, n);
+    resident_.erase(n);
+    if (!in_main) {
+        remember(hash);
+    }
+    return k;
+}
+
+const key_type
+S3FIFO_Evictor::peek_victim()
+{
+    capacity_ = resident_.size();
+    if (capacity_ == 0) {
+        return "";
+    }
+    return resident_[victim()].key;
+}
+
+void
+S3FIFO_Evictor::forget_key(const key_type& key)
+{
+    uint32_t n = resident_.find(key, resident_.hash(key));
+    if (n != NIL) {
+        (resident_[n].in_main ? main_ : small_).unlink(resident_, n);
+        resident_.erase(n);
+    }
+}
+
+void
+S3FIFO_Evictor::clear()
+{
+    resident_.clear();
+    ghosts_.clear();
+    small_ = main_ = ghost_queue_ = Index_List();
+    capacity_ = 0;
+}
+
+std::map<std::string, double>
+S3FIFO_Evictor::stats() const
+{
+    return {
+        { "s3fifo_small", double(small_.size) },
+        { "s3fifo_main", double(main_.size) },
+        { "s3fifo_ghost", double(ghost_queue_.size) },
+        { "s3fifo_ghost_hits", double(ghost_hits_) },
+    };
+}
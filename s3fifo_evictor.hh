@@ -0,0 +1,90 @@
+/*
+ * Declarations for an S3-FIFO eviction policy according to the pattern in evictor.hh.
+ * Implemented in s3fifo_evictor.cc.
+ *
+ * S3-FIFO (Yang et al., SOSP 2023) uses three FIFO queues: a small queue S
+ * that new keys enter, a main queue M, and a ghost queue G that remembers
+ * the hashes of keys recently evicted from S. Most keys are only used once
+ * and leave through S without ever reaching M. A key hit while in S moves to
+ * M when it reaches the head of S; a miss on a key in G goes straight into
+ * M. M is a CLOCK in FIFO order: each key has a small hit counter, and a key
+ * at M's head with hits left goes back to the tail with one less.
+ *
+ * Hits only bump a counter and never move a key, so mark_key() records them
+ * with relaxed atomics, as in the CLOCK evictors, and promotion is deferred
+ * to eviction time. Like ARC, the evictor takes the resident count at
+ * evict() as the cache's capacity.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "evictor.hh"
+#include "key_table.hh"
+
+class S3FIFO_Evictor final : public Evictor {
+private:
+    static constexpr uint8_t MAX_FREQ = 3;
+
+    struct Node {
+        key_type key;
+        std::size_t hash;
+        uint32_t prev;  // Towards the head of its queue
+        uint32_t next;  // Towards the tail
+        bool in_main;
+        mutable std::atomic<uint8_t> freq{0};   // Hits, up to MAX_FREQ
+
+        Node() = default;
+        Node(Node&& other) noexcept
+            : key(std::move(other.key)), hash(other.hash), prev(other.prev), next(other.next),
+              in_main(other.in_main), freq(other.freq.load(std::memory_order_relaxed)) {}
+    };
+    // A ghost's key is its hash
+    struct Ghost {
+        std::size_t key;
+        std::size_t hash;
+        uint32_t prev;
+        uint32_t next;
+    };
+    static constexpr uint32_t NIL = Key_Table<Node>::NIL;
+
+    Key_Table<Node> resident_;
+    Key_Table<Ghost, std::size_t> ghosts_;
+    Index_List small_, main_, ghost_queue_;
+    double small_ratio_;
+    std::size_t capacity_ = 0;      // Resident keys at the last evict()
+    uint64_t ghost_hits_ = 0;
+
+    void hit(const Node& node) const;
+    void remember(std::size_t hash);
+    uint32_t victim();
+
+public:
+    // small_ratio: share of the keys S holds before it is evicted from,
+    // between 0 and 1. The paper's 0.1 is the default.
+    explicit S3FIFO_Evictor(double small_ratio = 0.1);
+    S3FIFO_Evictor(const S3FIFO_Evictor&) = delete;
+    S3FIFO_Evictor& operator=(const S3FIFO_Evictor&) = delete;
+
+    void touch_key(const key_type&) override;
+    const key_type evict() override;
+    const key_type peek_victim() override;
+    bool empty() const override { return size() == 0; }
+    uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                         std::vector<key_type>& victims) override {
+        return evict_bytes_of(*this, bytes, size_of, victims);
+    }
+    void forget_key(const key_type&) override;
+    void clear() override;
+
+    bool concurrent_marks() const override { return true; }
+    void mark_key(const key_type&) const override;
+
+    // Sizes of S, M and G, and misses found in G
+    std::map<std::string, double> stats() const override;
+
+    // Number of resident keys, and how many of them are in S
+    std::size_t size() const { return resident_.size(); }
+    std::size_t small_size() const { return small_.size; }
+};
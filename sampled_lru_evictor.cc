@@ -0,0 +1,159 @@
+/*
+ * Implementation of the Sampled_LRU_Evictor declared in sampled_lru_evictor.hh.
+ */
+
+#include "sampled_lru_evictor.hh"
+#include <algorithm>
+#include <cassert>
+
+Sampled_LRU_Evictor::Sampled_LRU_Evictor(std::size_t samples)
+    : samples_(samples)
+{
+    assert(samples > 0 && "Need at least one sample per eviction");
+}
+
+uint32_t
+Sampled_LRU_Evictor::random_node()
+// A live record, picked uniformly. Erased records are recycled first, so
+// few of the indices below extent() are dead.
+{
+    for (;;) {
+        // xorshift64*
+        rng_ ^= rng_ >> 12;
+        rng_ ^= rng_ << 25;
+        rng_ ^= rng_ >> 27;
+        uint64_t r = rng_ * 0x2545f4914f6cdd1d;
+        uint32_t n = static_cast<uint32_t>((r >> 32) * nodes_.extent() >> 32);
+        if (nodes_[n].live) {
+            return n;
+        }
+    }
+}
+
+bool
+Sampled_LRU_Evictor::valid(const Candidate& candidate) const
+{
+    const Node& node = nodes_[candidate.node];
+    return node.live && node.hash == candidate.hash &&
+           node.stamp.load(std::memory_order_relaxed) == candidate.stamp;
+}
+
+void
+Sampled_LRU_Evictor::offer(uint32_t n)
+// Adds a sampled key to the pool, in order of idle time, unless the pool is
+// full of keys idle longer
+{
+    Candidate candidate{ n, nodes_[n].stamp.load(std::memory_order_relaxed), nodes_[n].hash };
+    uint32_t idle = clock_ - candidate.stamp;
+    std::size_t pos = 0;
+    while (pos < pool_size_ && clock_ - pool_[pos].stamp >= idle) {
+        if (pool_[pos].node == n && pool_[pos].stamp == candidate.stamp) {
+            return;     // Already there
+        }
+        ++pos;
+    }
+    if (pos == POOL_SIZE) {
+        return;
+    }
+    std::size_t last = pool_size_ < POOL_SIZE ? pool_size_++ : POOL_SIZE - 1;
+    for (std::size_t i = last; i > pos; --i) {
+        pool_[i] = pool_[i - 1];
+    }
+    pool_[pos] = candidate;
+}
+
+void
+Sampled_LRU_Evictor::touch_key(const key_type& key)
+{
+    std::size_t hash = nodes_.hash(key);
+    uint32_t n = nodes_.find(key, hash);
+    if (n == NIL) {
+        n = nodes_.insert(key, hash);
+        nodes_[n].live = true;
+    }
+    nodes_[n].stamp.store(++clock_, std::memory_order_relaxed);
+}
+
+void
+Sampled_LRU_Evictor::mark_key(const key_type& key) const
+{
+    uint32_t n = nodes_.find(key, nodes_.hash(key));
+    if (n != NIL) {
+        nodes_[n].stamp.store(clock_, std::memory_order_relaxed);
+    }
+}
+
+uint32_t
+Sampled_LRU_Evictor::choose()
+// Samples into the pool, then drops stale candidates from its front, so the
+// longest idle valid one is first. Right after peek_victim() it already is,
+// and sampling again could put another ahead of it.
+{
+    for (;;) {
+        if (!peeked_) {
+            for (std::size_t i = 0; i < samples_; ++i) {
+                offer(random_node());
+            }
+        }
+        peeked_ = false;
+        std::size_t stale = 0;
+        while (stale < pool_size_ && !valid(pool_[stale])) {
+            ++stale;
+        }
+        if (stale == pool_size_) {
+            pool_size_ = 0;     // Every candidate went stale; sample afresh
+            continue;
+        }
+        std::copy(pool_ + stale, pool_ + pool_size_, pool_);
+        pool_size_ -= stale;
+        return pool_[0].node;
+    }
+}
+
+const key_type
+Sampled_LRU_Evictor::evict()
+{
+    if (nodes_.size() == 0) {
+        return "";
+    }
+    uint32_t n = choose();
+    std::copy(pool_ + 1, pool_ + pool_size_, pool_);
+    --pool_size_;
+
+    Node& node = nodes_[n];
+    node.live = false;
+    key_type k = node.key;
+    nodes_.erase(n);
+    return k;
+}
+
+const key_type
+Sampled_LRU_Evictor::peek_victim()
+{
+    if (nodes_.size() == 0) {
+        return "";
+    }
+    uint32_t n = choose();
+    peeked_ = true;
+    return nodes_[n].key;
+}
+
+void
+Sampled_LRU_Evictor::forget_key(const key_type& key)
+// Pool entries for it go stale and are dropped when reached
+{
+    uint32_t n = nodes_.find(key, nodes_.hash(key));
+    if (n != NIL) {
+        nodes_[n].live = false;
+        nodes_.erase(n);
+    }
+}
+
+void
+Sampled_LRU_Evictor::clear()
+{
+    nodes_.clear();
+    pool_size_ = 0;
+    peeked_ = false;
+    clock_ = 0;
+}
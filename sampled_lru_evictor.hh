@@ -0,0 +1,88 @@
+/*
+ * Declarations for a sampled, approximate LRU eviction policy according to the pattern in evictor.hh.
+ * Implemented in sampled_lru_evictor.cc.
+ *
+ * Like Redis's maxmemory-policy allkeys-lru, this keeps no recency order at
+ * all. Each key carries a coarse timestamp: a logical clock that ticks on
+ * every touch_key(), that is on every write. Hits only store the current
+ * clock into the key's stamp, with a relaxed atomic through mark_key(), so a
+ * get updates no list and moves no pointer. To evict, the evictor samples a
+ * few keys at random and takes the one idle longest. A small pool carries
+ * the best candidates seen over from one eviction to the next, which brings
+ * the result close to true LRU with only a handful of samples each time.
+ *
+ * Keys are sampled from the evictor's own Key_Table rather than from the
+ * cache's index: the table's record array is dense, so a random index
+ * almost always names a live key, and since the cache reports deletes
+ * (forget_key()) it holds exactly the cache's keys.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "evictor.hh"
+#include "key_table.hh"
+
+class Sampled_LRU_Evictor final : public Evictor {
+private:
+    struct Node {
+        key_type key;
+        std::size_t hash;
+        bool live = false;
+        mutable std::atomic<uint32_t> stamp{0};    // Clock at the last touch or hit
+
+        Node() = default;
+        Node(Node&& other) noexcept
+            : key(std::move(other.key)), hash(other.hash), live(other.live),
+              stamp(other.stamp.load(std::memory_order_relaxed)) {}
+    };
+    using Table = Key_Table<Node>;
+    static constexpr uint32_t NIL = Table::NIL;
+
+    // A sampled candidate. It is only evicted if its node still holds the
+    // same key, untouched since it was sampled.
+    struct Candidate {
+        uint32_t node;
+        uint32_t stamp;
+        std::size_t hash;
+    };
+    static constexpr std::size_t POOL_SIZE = 16;
+
+    Table nodes_;
+    Candidate pool_[POOL_SIZE];     // Idle longest first
+    std::size_t pool_size_ = 0;
+    bool peeked_ = false;           // pool_[0] is what peek_victim() returned
+    std::size_t samples_;
+    uint32_t clock_ = 0;
+    uint64_t rng_ = 0x9e3779b97f4a7c15;
+
+    uint32_t random_node();
+    void offer(uint32_t n);
+    bool valid(const Candidate& candidate) const;
+    uint32_t choose();
+
+public:
+    // samples: keys looked at per eviction. Redis uses 5; more is closer to
+    // LRU and slower.
+    explicit Sampled_LRU_Evictor(std::size_t samples = 5);
+    Sampled_LRU_Evictor(const Sampled_LRU_Evictor&) = delete;
+    Sampled_LRU_Evictor& operator=(const Sampled_LRU_Evictor&) = delete;
+
+    void touch_key(const key_type&) override;
+    const key_type evict() override;
+    const key_type peek_victim() override;
+    bool empty() const override { return size() == 0; }
+    uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                         std::vector<key_type>& victims) override {
+        return evict_bytes_of(*this, bytes, size_of, victims);
+    }
+    void forget_key(const key_type&) override;
+    void clear() override;
+
+    bool concurrent_marks() const override { return true; }
+    void mark_key(const key_type&) const override;
+
+    // Number of keys currently tracked
+    std::size_t size() const { return nodes_.size(); }
+};
@@ -0,0 +1,416 @@
+/*
+ * Implementation of the ShardedCache declared in "sharded_cache.hh".
+ */
+
+#include "sharded_cache.hh"
+#include <algorithm>
+#include <cassert>
+#include "epoch.hh"
+
+// Padded to its own cache lines so one shard's lock traffic doesn't slow down
+// its neighbours.
+struct alignas(64) ShardedCache::Shard {
+    mutable std::shared_mutex mutex;
+    // Both replaced wholesale by reset(), under mutex
+    std::unique_ptr<Evictor> evictor;
+    std::unique_ptr<Cache> cache;
+    // The same cache, for readers that don't hold mutex: they must be pinned
+    // (see "epoch.hh") from loading it until they are done with it
+    std::atomic<const Cache*> current;
+    // Misses answered by the key filter alone, and misses it let through
+    mutable std::atomic<uint64_t> filter_rejects{0};
+    mutable std::atomic<uint64_t> filter_false_positives{0};
+    size_type maxmem;
+    // Maintenance watermarks in bytes, guarded by mutex. high_mark is
+    // maxmem while no maintenance thread runs, so sets never wake it.
+    size_type high_mark;
+    size_type low_mark;
+
+    Shard(size_type maxmem, float max_load_factor, std::unique_ptr<Evictor> ev,
+          bool count_overhead)
+        : evictor(std::move(ev)),
+          cache(new Cache(maxmem, max_load_factor, evictor.get(), Fast_Hash(), count_overhead)),
+          maxmem(maxmem),
+          high_mark(maxmem),
+          low_mark(maxmem)
+    {
+        current.store(cache.get(), std::memory_order_release);
+    }
+
+    // Whether key may be in the shard, asked without the lock. The caller is pinned.
+    bool may_contain(std::string_view key) const {
+        if (current.load(std::memory_order_acquire)->may_contain(key)) {
+            return true;
+        }
+        filter_rejects.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+};
+
+ShardedCache::ShardedCache(std::size_t num_shards,
+                           size_type maxmem,
+                           float max_load_factor,
+                           evictor_factory make_evictor,
+                           bool count_overhead)
+    : make_evictor_(std::move(make_evictor)),
+      max_load_factor_(max_load_factor),
+      count_overhead_(count_overhead)
+{
+    assert(num_shards > 0 && "Need at least one shard");
+    for (std::size_t i = 0; i < num_shards; ++i) {
+        // The first shards absorb the remainder so the total is exactly maxmem
+        size_type shard_mem = maxmem / num_shards + (i < maxmem % num_shards ? 1 : 0);
+        std::unique_ptr<Evictor> evictor = make_evictor_ ? make_evictor_() : nullptr;
+        shards_.push_back(std::make_unique<Shard>(shard_mem, max_load_factor, std::move(evictor),
+                                                  count_overhead));
+    }
+}
+
+ShardedCache::~ShardedCache()
+{
+    stop_maintenance();
+    if (reaper_.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(reaper_mutex_);
+            reaper_stopping_ = true;
+        }
+        reaper_wakeup_.notify_one();
+        reaper_.join();
+    }
+}
+
+ShardedCache::Shard&
+ShardedCache::shard_for(std::string_view key) const
+{
+    // Same hash as the shards' own tables. They take their slot and control
+    // byte from the low bits after folding the high half in, so picking the
+    // shard from the high half leaves every shard's slots evenly used.
+    uint64_t h = Fast_Hash()(key);
+    return *shards_[(h >> 32) % shards_.size()];
+}
+
+void
+ShardedCache::set(key_type key, val_type val, size_type size, ttl_type ttl)
+{
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> guard(shard.mutex);
+    shard.cache->set(std::move(key), val, size, ttl);
+    after_set(shard);
+}
+
+void
+ShardedCache::set(std::string_view key, std::string_view val, size_type size, ttl_type ttl)
+{
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> guard(shard.mutex);
+    shard.cache->set(key, val, size, ttl);
+    after_set(shard);
+}
+
+void
+ShardedCache::set(key_type&& key, std::string&& val, size_type size, ttl_type ttl)
+{
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> guard(shard.mutex);
+    shard.cache->set(std::move(key), std::move(val), size, ttl);
+    after_set(shard);
+}
+
+bool
+ShardedCache::get(key_type key, std::string& val, size_type& val_size) const
+{
+    Shard& shard = shard_for(key);
+    // Pinned even before the lock, for the filter. That's safe because
+    // nothing waits for pinned readers while holding a shard lock: reset()
+    // leaves that to the reaper.
+    Epoch_Guard pin;
+    if (!shard.may_contain(key)) {
+        return false;
+    }
+    std::shared_lock<std::shared_mutex> guard(shard.mutex);
+    const Cache& cache = *shard.cache;
+    val_type result = cache.get_shared(key, val_size);
+    guard.unlock();
+    if (result == nullptr) {
+        shard.filter_false_positives.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // The bytes can't be freed while we're pinned, even if a writer has
+    // already replaced them or reset() swapped the whole cache out. Values
+    // may hold NULs, so don't stop at the first.
+    val.assign(result, cache.stored_length(result));
+    return true;
+}
+
+Cache::Value_Handle
+ShardedCache::get(std::string_view key) const
+{
+    Shard& shard = shard_for(key);
+    {
+        Epoch_Guard pin;
+        if (!shard.may_contain(key)) {
+            return Cache::Value_Handle();
+        }
+    }
+    std::shared_lock<std::shared_mutex> guard(shard.mutex);
+    Cache::Value_Handle handle = shard.cache->get(key);
+    if (!handle) {
+        shard.filter_false_positives.fetch_add(1, std::memory_order_relaxed);
+    }
+    return handle;
+}
+
+bool
+ShardedCache::del(std::string_view key)
+{
+    Shard& shard = shard_for(key);
+    {
+        Epoch_Guard pin;
+        if (!shard.may_contain(key)) {
+            return false;
+        }
+    }
+    std::unique_lock<std::shared_mutex> guard(shard.mutex);
+    if (!shard.cache->del(key)) {
+        shard.filter_false_positives.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+ShardedCache::size_type
+ShardedCache::space_used() const
+{
+    size_type total = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> guard(shard->mutex);
+        total += shard->cache->space_used();
+    }
+    return total;
+}
+
+std::size_t
+ShardedCache::memory_used() const
+{
+    std::size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> guard(shard->mutex);
+        total += shard->cache->memory_used();
+    }
+    return total;
+}
+
+void
+ShardedCache::reset()
+// Each shard gets a new, empty cache and evictor, which takes as long as
+// making them, however much the old ones hold. The reaper thread frees
+// those once no reader can be using them.
+{
+    std::vector<Retired> retired;
+    for (auto& shard : shards_) {
+        std::unique_ptr<Evictor> evictor = make_evictor_ ? make_evictor_() : nullptr;
+        std::unique_ptr<Cache> cache(new Cache(shard->maxmem, max_load_factor_, evictor.get(),
+                                               Fast_Hash(), count_overhead_));
+        {
+            std::unique_lock<std::shared_mutex> guard(shard->mutex);
+            std::swap(shard->evictor, evictor);
+            std::swap(shard->cache, cache);
+            shard->current.store(shard->cache.get(), std::memory_order_release);
+        }
+        retired.push_back(Retired{ std::move(evictor), std::move(cache) });
+    }
+    resets_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> guard(reaper_mutex_);
+    for (auto& old : retired) {
+        graveyard_.push_back(std::move(old));
+    }
+    reset_pending_.store(graveyard_.size(), std::memory_order_relaxed);
+    if (!reaper_.joinable()) {
+        reaper_ = std::thread([this] { reap(); });
+    }
+    reaper_wakeup_.notify_one();
+}
+
+void
+ShardedCache::reap()
+// Body of the reaper thread. Readers that found a value in a swapped-out
+// cache may still be copying it (under an Epoch_Guard) or hold a
+// Value_Handle to it, so wait for both before freeing anything.
+{
+    std::unique_lock<std::mutex> lock(reaper_mutex_);
+    for (;;) {
+        reaper_wakeup_.wait(lock, [this] { return reaper_stopping_ || !graveyard_.empty(); });
+        if (graveyard_.empty()) {
+            break;   // Stopping, with nothing left to free
+        }
+        std::vector<Retired> batch;
+        batch.swap(graveyard_);
+        lock.unlock();
+        Epoch_Manager::global().synchronize();
+        for (auto& old : batch) {
+            while (old.cache->pinned()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            // The cache goes first: it still points at the evictor
+            old.cache.reset();
+            old.evictor.reset();
+            reset_pending_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        lock.lock();
+    }
+}
+
+namespace {
+bool ends_with(const std::string& name, const std::string& suffix)
+{
+    return name.size() >= suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+}
+
+ShardedCache::stats_type
+ShardedCache::stats() const
+// Counters are summed. Per-class ratios can't be summed, so they are
+// recomputed from the summed counts afterwards.
+{
+    stats_type total;
+    double rejects = 0, false_positives = 0;
+    for (const auto& shard : shards_) {
+        rejects += shard->filter_rejects.load(std::memory_order_relaxed);
+        false_positives += shard->filter_false_positives.load(std::memory_order_relaxed);
+        std::shared_lock<std::shared_mutex> guard(shard->mutex);
+        for (const auto& stat : shard->cache->stats()) {
+            if (ends_with(stat.first, ".chunk_size")) {
+                total[stat.first] = stat.second;
+            }
+            else if (!ends_with(stat.first, ".occupancy") && !ends_with(stat.first, ".fragmentation")) {
+                total[stat.first] += stat.second;
+            }
+        }
+    }
+    for (auto& stat : total) {
+        if (!ends_with(stat.first, ".chunk_size")) {
+            continue;
+        }
+        std::string prefix = stat.first.substr(0, stat.first.size() - std::string("chunk_size").size());
+        double used = total[prefix + "used_chunks"];
+        double carved = total[prefix + "total_chunks"];
+        double requested = total[prefix + "requested_bytes"];
+        total[prefix + "occupancy"] = carved == 0 ? 0 : used / carved;
+        total[prefix + "fragmentation"] = used == 0 ? 0 : 1 - requested / (used * stat.second);
+    }
+    total["shards"] = shards_.size();
+    total["maintenance_passes"] = maintenance_passes_.load(std::memory_order_relaxed);
+    total["maintenance_wakeups"] = maintenance_wakeups_.load(std::memory_order_relaxed);
+    total["filter_rejects"] = rejects;
+    total["filter_false_positives"] = false_positives;
+    total["filter_false_positive_rate"] =
+        rejects + false_positives == 0 ? 0 : false_positives / (rejects + false_positives);
+    total["resets"] = resets_.load(std::memory_order_relaxed);
+    total["reset_pending"] = reset_pending_.load(std::memory_order_relaxed);
+    return total;
+}
+
+std::size_t
+ShardedCache::num_shards() const
+{
+    return shards_.size();
+}
+
+void
+ShardedCache::start_maintenance(double high, double low, std::chrono::milliseconds interval)
+{
+    assert(0 <= low && low <= high && high <= 1 && "Need 0 <= low <= high <= 1");
+    stop_maintenance();
+    for (auto& shard : shards_) {
+        std::unique_lock<std::shared_mutex> guard(shard->mutex);
+        shard->high_mark = static_cast<size_type>(high * shard->maxmem);
+        shard->low_mark = static_cast<size_type>(low * shard->maxmem);
+    }
+    maintenance_interval_ = interval;
+    stopping_ = false;
+    maintainer_ = std::thread([this] { maintain(); });
+}
+
+void
+ShardedCache::stop_maintenance()
+{
+    if (!maintainer_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(maintenance_mutex_);
+        stopping_ = true;
+    }
+    maintenance_wakeup_.notify_one();
+    maintainer_.join();
+    for (auto& shard : shards_) {
+        std::unique_lock<std::shared_mutex> guard(shard->mutex);
+        shard->high_mark = shard->low_mark = shard->maxmem;
+    }
+}
+
+void
+ShardedCache::after_set(const Shard& shard)
+// Only the first set to find the shard past its mark pays for the wakeup;
+// the rest see the flag already raised.
+{
+    if (shard.cache->space_used() > shard.high_mark &&
+        !wakeup_pending_.exchange(true, std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> guard(maintenance_mutex_);
+        maintenance_wakeup_.notify_one();
+    }
+}
+
+void
+ShardedCache::maintain()
+// Body of the maintenance thread
+{
+    std::unique_lock<std::mutex> lock(maintenance_mutex_);
+    while (!stopping_) {
+        if (maintenance_wakeup_.wait_for(lock, maintenance_interval_, [this] {
+                return stopping_ || wakeup_pending_.load(std::memory_order_relaxed);
+            })) {
+            maintenance_wakeups_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (stopping_) {
+            break;
+        }
+        wakeup_pending_.store(false, std::memory_order_relaxed);
+        lock.unlock();
+        maintenance_passes_.fetch_add(1, std::memory_order_relaxed);
+        for (auto& shard : shards_) {
+            // Expired values go first: they may free enough already. A shard
+            // with no TTLs is passed over without taking it exclusively.
+            bool timed;
+            {
+                std::shared_lock<std::shared_mutex> guard(shard->mutex);
+                timed = shard->cache->ttl_entries() != 0;
+            }
+            for (bool more = timed; more; ) {
+                std::unique_lock<std::shared_mutex> guard(shard->mutex);
+                more = shard->cache->expire(EXPIRE_SLICE) == EXPIRE_SLICE;
+            }
+            {
+                std::shared_lock<std::shared_mutex> guard(shard->mutex);
+                if (shard->cache->space_used() <= shard->high_mark) {
+                    continue;
+                }
+            }
+            // A sixteenth of the shard per lock hold, so nothing waits long
+            size_type slice = std::max<size_type>(1, shard->maxmem / 16);
+            for (;;) {
+                std::unique_lock<std::shared_mutex> guard(shard->mutex);
+                size_type used = shard->cache->space_used();
+                if (used <= shard->low_mark) {
+                    break;
+                }
+                size_type target = used - std::min(used - shard->low_mark, slice);
+                if (shard->cache->evict_to(target) == 0) {
+                    break;   // Nothing left to evict
+                }
+            }
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,146 @@
+/*
+ * A thread-safe cache made of several independent Cache shards.
+ * Implemented in "sharded_cache.cc".
+ *
+ * Keys are spread across the shards by hash. Each shard has its own lock,
+ * evictor and slice of maxmem, so requests for keys in different shards never
+ * wait on each other. Used by cache_server.cc in place of one global mutex.
+ *
+ * Shard locks are reader-writer locks: gets only take them shared, so gets on
+ * the same shard run in parallel, and the value is copied out after the lock
+ * is released (under an Epoch_Guard, see "epoch.hh").
+ *
+ * Optionally a maintenance thread evicts ahead of the sets: when a shard's
+ * usage passes a high watermark it evicts down to a low one, so a set seldom
+ * finds its shard full and has to evict under the lock itself. It also
+ * removes expired values a slice at a time.
+ *
+ * Gets and deletes first ask the shard's key filter (see Cache::may_contain())
+ * whether the key can be there at all, before taking the lock, so requests
+ * for keys that were never set don't contend with the shard's writers.
+ *
+ * reset() swaps each shard's cache and evictor for new, empty ones, so it
+ * doesn't hold the shard locks while millions of entries are freed; a reaper
+ * thread frees the old ones behind it.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "cache.hh"
+
+class ShardedCache {
+ public:
+  using size_type = Cache::size_type;
+  using val_type = Cache::val_type;
+  using stats_type = Cache::stats_type;
+  using ttl_type = Cache::ttl_type;
+
+  // Builds the evictor for one shard (may return nullptr for no evictions).
+  using evictor_factory = std::function<std::unique_ptr<Evictor>()>;
+
+  // Split 'maxmem' evenly over 'num_shards' shards, each with its own evictor.
+  // count_overhead is passed on to each shard (see Cache's constructor).
+  ShardedCache(std::size_t num_shards,
+               size_type maxmem,
+               float max_load_factor = 0.75,
+               evictor_factory make_evictor = nullptr,
+               bool count_overhead = false);
+  ~ShardedCache();
+
+  ShardedCache(const ShardedCache&) = delete;
+  ShardedCache& operator=(const ShardedCache&) = delete;
+
+  // Same semantics as the corresponding Cache calls, but safe to call from
+  // any number of threads at once.
+  void set(key_type key, val_type val, size_type size, ttl_type ttl = ttl_type::zero());
+  void set(std::string_view key, std::string_view val, size_type size,
+           ttl_type ttl = ttl_type::zero());
+  void set(key_type&& key, std::string&& val, size_type size, ttl_type ttl = ttl_type::zero());
+  bool del(std::string_view key);
+
+  // Copy the value for key into 'val', NULs included. Returns false on a miss.
+  bool get(key_type key, std::string& val, size_type& val_size) const;
+
+  // Reference the value for key without copying it (see Cache::Value_Handle).
+  // The shard lock is only held for the lookup.
+  Cache::Value_Handle get(std::string_view key) const;
+
+  // Totals over all shards.
+  size_type space_used() const;
+  std::size_t memory_used() const;
+  // Empty every shard, and its evictor, in time independent of how much
+  // they hold. memory_used() leaves out the old contents still being freed.
+  void reset();
+
+  // Counters summed over all shards, plus the shard count. The key filter's
+  // false-positive rate is filter_false_positives over the misses it was
+  // asked about (those plus filter_rejects).
+  stats_type stats() const;
+
+  std::size_t num_shards() const;
+
+  // Start the maintenance thread. The watermarks are fractions of each
+  // shard's maxmem, with 0 <= low <= high <= 1. A set that takes its shard past
+  // 'high' wakes the thread; it also looks at every shard each 'interval'.
+  // Shards are evicted down to 'low', and rid of expired values, a slice at a
+  // time, releasing the shard lock in between so gets and sets aren't held up
+  // for the whole run. With high = 1 only sets evict, and the thread just
+  // expires values.
+  void start_maintenance(double high, double low,
+                         std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+  // Stop and join the thread, if running. The destructor does this too.
+  void stop_maintenance();
+
+ private:
+  struct Shard;
+
+  Shard& shard_for(std::string_view key) const;
+  // After a set: wake the maintenance thread if the shard is past its mark.
+  // Called with the shard locked.
+  void after_set(const Shard& shard);
+  void maintain();
+  void reap();
+
+  // Expired values the maintenance thread removes per shard lock hold
+  static constexpr std::size_t EXPIRE_SLICE = 256;
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  // What reset() needs to make new shard contents
+  evictor_factory make_evictor_;
+  float max_load_factor_;
+  bool count_overhead_;
+
+  std::thread maintainer_;
+  std::mutex maintenance_mutex_;
+  std::condition_variable maintenance_wakeup_;
+  std::chrono::milliseconds maintenance_interval_{0};
+  bool stopping_ = false;
+  std::atomic<bool> wakeup_pending_{false};
+  std::atomic<uint64_t> maintenance_passes_{0};
+  std::atomic<uint64_t> maintenance_wakeups_{0};
+
+  // A shard's contents after reset() swapped them out, for the reaper
+  struct Retired {
+    std::unique_ptr<Evictor> evictor;
+    std::unique_ptr<Cache> cache;
+  };
+  std::thread reaper_;
+  std::mutex reaper_mutex_;
+  std::condition_variable reaper_wakeup_;
+  std::vector<Retired> graveyard_;
+  bool reaper_stopping_ = false;
+  std::atomic<uint64_t> resets_{0};
+  std::atomic<uint64_t> reset_pending_{0};
+};
@@ -0,0 +1,328 @@
+/*
+ * Implementation of the Slab_Allocator declared in "slab_allocator.hh".
+ */
+
+#include "slab_allocator.hh"
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+// Every chunk starts with this header, followed directly by the payload.
+// Free chunks reuse 'next' as the free list link.
+struct Slab_Allocator::Chunk {
+    Chunk* prev;
+    Chunk* next;
+    void* owner;
+    uint32_t length;
+    uint8_t cls;
+    uint8_t detached;   // Off the LRU, waiting to be released
+    std::atomic<uint16_t> refs;  // Outstanding pins (see pin())
+};
+
+struct Slab_Allocator::Slab_Class {
+    std::size_t chunk_size;     // Payload bytes
+    std::size_t stride;         // Header + payload, rounded for alignment
+    std::vector<std::unique_ptr<byte_type[]>> pages;
+    std::size_t total_chunks = 0;
+    std::size_t used_chunks = 0;
+    std::size_t requested_bytes = 0;
+    Chunk* free_list = nullptr;
+    Chunk* lru_head = nullptr;  // Least recently used
+    Chunk* lru_tail = nullptr;  // Most recently used
+    Chunk* detached_head = nullptr;  // Detached chunks, unordered
+    Chunk* detached_tail = nullptr;
+};
+
+namespace {
+constexpr std::size_t ALIGN = alignof(std::max_align_t);
+
+std::size_t round_up(std::size_t n, std::size_t to)
+{
+    return (n + to - 1) / to * to;
+}
+}
+
+double
+Slab_Allocator::Class_Stats::fragmentation() const
+{
+    if (used_chunks == 0) return 0.;
+    return 1. - static_cast<double>(requested_bytes) / (used_chunks * chunk_size);
+}
+
+double
+Slab_Allocator::Class_Stats::occupancy() const
+{
+    if (total_chunks == 0) return 0.;
+    return static_cast<double>(used_chunks) / total_chunks;
+}
+
+Slab_Allocator::Slab_Allocator(std::size_t page_size,
+                               double growth_factor,
+                               std::size_t min_chunk,
+                               std::size_t max_pages)
+    : page_size_(page_size), max_pages_(max_pages)
+{
+    assert(growth_factor > 1. && "Slab classes must grow");
+    static_assert(sizeof(Chunk) <= 32, "Chunk header should stay small");
+    // Chunk sizes grow geometrically until a page would hold only one chunk.
+    std::size_t size = min_chunk;
+    while (round_up(sizeof(Chunk) + size, ALIGN) * 2 <= page_size_) {
+        Slab_Class cls;
+        cls.chunk_size = size;
+        cls.stride = round_up(sizeof(Chunk) + size, ALIGN);
+        classes_.push_back(std::move(cls));
+        std::size_t next = static_cast<std::size_t>(size * growth_factor);
+        size = (next > size) ? next : size + 1;
+    }
+    // The large class: one dedicated allocation per value.
+    Slab_Class large;
+    large.chunk_size = 0;
+    large.stride = 0;
+    classes_.push_back(std::move(large));
+    assert(classes_.size() <= 256 && "Class index must fit in a chunk header");
+}
+
+Slab_Allocator::~Slab_Allocator()
+{
+    clear();
+}
+
+void
+Slab_Allocator::set_budget(std::size_t bytes)
+{
+    max_pages_ = bytes / page_size_ + (classes_.size() - 1);
+}
+
+std::size_t
+Slab_Allocator::class_for(std::size_t length) const
+// Binary search over the (sorted) regular classes
+{
+    std::size_t lo = 0, hi = classes_.size() - 1;
+    while (lo < hi) {
+        std::size_t mid = (lo + hi) / 2;
+        if (classes_[mid].chunk_size >= length) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+std::size_t
+Slab_Allocator::footprint(std::size_t length) const
+{
+    const Slab_Class& cls = classes_[class_for(length)];
+    return cls.stride != 0 ? cls.stride : round_up(sizeof(Chunk), ALIGN) + length;
+}
+
+std::size_t
+Slab_Allocator::num_classes() const
+{
+    return classes_.size();
+}
+
+Slab_Allocator::Chunk*
+Slab_Allocator::header(const byte_type* data)
+{
+    return reinterpret_cast<Chunk*>(const_cast<byte_type*>(data) - round_up(sizeof(Chunk), ALIGN));
+}
+
+bool
+Slab_Allocator::grow(Slab_Class& cls)
+// Carve a fresh page into chunks and put them on the class's free list
+{
+    if (max_pages_ != 0 && pages_ >= max_pages_) return false;
+    cls.pages.push_back(std::make_unique<byte_type[]>(page_size_));
+    ++pages_;
+    byte_type* page = cls.pages.back().get();
+    std::size_t count = page_size_ / cls.stride;
+    for (std::size_t i = count; i > 0; --i) {
+        Chunk* chunk = reinterpret_cast<Chunk*>(page + (i - 1) * cls.stride);
+        chunk->next = cls.free_list;
+        cls.free_list = chunk;
+    }
+    cls.total_chunks += count;
+    return true;
+}
+
+void
+Slab_Allocator::lru_unlink(Slab_Class& cls, Chunk* chunk)
+// Detached chunks sit on their own list, linked the same way
+{
+    Chunk*& head = chunk->detached ? cls.detached_head : cls.lru_head;
+    Chunk*& tail = chunk->detached ? cls.detached_tail : cls.lru_tail;
+    if (chunk->prev != nullptr) chunk->prev->next = chunk->next;
+    else head = chunk->next;
+    if (chunk->next != nullptr) chunk->next->prev = chunk->prev;
+    else tail = chunk->prev;
+}
+
+void
+Slab_Allocator::lru_push(Slab_Class& cls, Chunk* chunk)
+{
+    Chunk*& head = chunk->detached ? cls.detached_head : cls.lru_head;
+    Chunk*& tail = chunk->detached ? cls.detached_tail : cls.lru_tail;
+    chunk->prev = tail;
+    chunk->next = nullptr;
+    if (tail != nullptr) tail->next = chunk;
+    else head = chunk;
+    tail = chunk;
+}
+
+Slab_Allocator::byte_type*
+Slab_Allocator::allocate(std::size_t length, void* owner)
+{
+    if (length > MAX_LENGTH) return nullptr;
+    std::size_t index = class_for(length);
+    Slab_Class& cls = classes_[index];
+    Chunk* chunk;
+    if (index == classes_.size() - 1) {
+        // Header is padded to ALIGN so the payload stays aligned
+        std::size_t bytes = round_up(sizeof(Chunk), ALIGN) + length;
+        chunk = static_cast<Chunk*>(std::malloc(bytes));
+        if (chunk == nullptr) return nullptr;
+        large_bytes_ += bytes;
+        ++cls.total_chunks;
+    }
+    else {
+        if (cls.free_list == nullptr && !grow(cls)) return nullptr;
+        chunk = cls.free_list;
+        cls.free_list = chunk->next;
+    }
+    chunk->owner = owner;
+    chunk->length = static_cast<uint32_t>(length);
+    chunk->cls = static_cast<uint8_t>(index);
+    chunk->detached = 0;
+    new (&chunk->refs) std::atomic<uint16_t>(0);
+    ++cls.used_chunks;
+    cls.requested_bytes += length;
+    lru_push(cls, chunk);
+    return reinterpret_cast<byte_type*>(chunk) + round_up(sizeof(Chunk), ALIGN);
+}
+
+void
+Slab_Allocator::release(byte_type* data)
+{
+    Chunk* chunk = header(data);
+    Slab_Class& cls = classes_[chunk->cls];
+    lru_unlink(cls, chunk);
+    --cls.used_chunks;
+    cls.requested_bytes -= chunk->length;
+    if (chunk->cls == classes_.size() - 1) {
+        large_bytes_ -= round_up(sizeof(Chunk), ALIGN) + chunk->length;
+        --cls.total_chunks;
+        std::free(chunk);
+        return;
+    }
+    chunk->next = cls.free_list;
+    cls.free_list = chunk;
+}
+
+void
+Slab_Allocator::detach(byte_type* data)
+{
+    Chunk* chunk = header(data);
+    if (chunk->detached) return;
+    Slab_Class& cls = classes_[chunk->cls];
+    lru_unlink(cls, chunk);
+    chunk->detached = 1;
+    chunk->owner = nullptr;
+    lru_push(cls, chunk);
+}
+
+void
+Slab_Allocator::touch(byte_type* data)
+{
+    Chunk* chunk = header(data);
+    Slab_Class& cls = classes_[chunk->cls];
+    if (chunk->detached || cls.lru_tail == chunk) return;
+    lru_unlink(cls, chunk);
+    lru_push(cls, chunk);
+}
+
+bool
+Slab_Allocator::pin(const byte_type* data)
+{
+    std::atomic<uint16_t>& refs = header(data)->refs;
+    uint16_t count = refs.load(std::memory_order_relaxed);
+    do {
+        if (count == UINT16_MAX) return false;
+    } while (!refs.compare_exchange_weak(count, count + 1, std::memory_order_acquire));
+    return true;
+}
+
+void
+Slab_Allocator::unpin(const byte_type* data)
+{
+    header(data)->refs.fetch_sub(1, std::memory_order_release);
+}
+
+bool
+Slab_Allocator::pinned(const byte_type* data) const
+{
+    return header(data)->refs.load(std::memory_order_acquire) != 0;
+}
+
+void*
+Slab_Allocator::lru_victim(std::size_t length) const
+{
+    const Slab_Class& cls = classes_[class_for(length)];
+    return cls.lru_head == nullptr ? nullptr : cls.lru_head->owner;
+}
+
+std::size_t
+Slab_Allocator::length(const byte_type* data) const
+{
+    return header(data)->length;
+}
+
+std::vector<Slab_Allocator::Class_Stats>
+Slab_Allocator::stats() const
+{
+    std::vector<Class_Stats> result;
+    for (const auto& cls : classes_) {
+        Class_Stats s;
+        s.chunk_size = cls.chunk_size;
+        s.pages = cls.pages.size();
+        s.total_chunks = cls.total_chunks;
+        s.used_chunks = cls.used_chunks;
+        s.requested_bytes = cls.requested_bytes;
+        if (&cls == &classes_.back()) {
+            // Large values fill their allocation exactly
+            s.chunk_size = cls.used_chunks == 0 ? 0 : cls.requested_bytes / cls.used_chunks;
+        }
+        result.push_back(s);
+    }
+    return result;
+}
+
+std::size_t
+Slab_Allocator::reserved() const
+{
+    return pages_ * page_size_ + large_bytes_;
+}
+
+void
+Slab_Allocator::clear()
+{
+    Slab_Class& large = classes_.back();
+    for (Chunk* list : { large.lru_head, large.detached_head }) {
+        while (list != nullptr) {
+            Chunk* next = list->next;
+            std::free(list);
+            list = next;
+        }
+    }
+    for (auto& cls : classes_) {
+        cls.pages.clear();
+        cls.total_chunks = 0;
+        cls.used_chunks = 0;
+        cls.requested_bytes = 0;
+        cls.free_list = nullptr;
+        cls.lru_head = nullptr;
+        cls.lru_tail = nullptr;
+        cls.detached_head = nullptr;
+        cls.detached_tail = nullptr;
+    }
+    pages_ = 0;
+    large_bytes_ = 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * Declarations for a memcached-style slab allocator, BasicCache's default
+ * storage for cache values (see "basic_cache.hh"). Implemented in "slab_allocator.cc".
+ *
+ * Memory is taken from the system in fixed-size pages. Each page belongs to one
+ * size class and is cut into equal chunks; chunk sizes grow geometrically from
+ * one class to the next. Freed chunks go back on their class's free list, so a
+ * churning workload reuses the same chunks instead of calling malloc, and the
+ * waste per value is bounded by the growth factor.
+ *
+ * Every class also keeps its own LRU list of live chunks, so when a class has
+ * run out of pages the caller can find the oldest value of the right size.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Slab_Allocator {
+ public:
+  using byte_type = char;
+
+  // Largest length allocate() accepts; chunk headers store it in 32 bits.
+  static constexpr std::size_t MAX_LENGTH = UINT32_MAX;
+
+  // Per-class occupancy, for stats reporting.
+  struct Class_Stats {
+    std::size_t chunk_size;       // Bytes of payload a chunk can hold
+    std::size_t pages;            // Pages assigned to this class
+    std::size_t total_chunks;     // Chunks carved out of those pages
+    std::size_t used_chunks;      // Chunks currently holding a value
+    std::size_t requested_bytes;  // Payload bytes actually asked for
+    // Fraction of the used chunk space that holds no payload (internal waste).
+    double fragmentation() const;
+    // Fraction of carved chunks that are in use.
+    double occupancy() const;
+  };
+
+  // page_size: bytes requested from the system at a time.
+  // growth_factor: ratio between consecutive chunk sizes (memcached's -f).
+  // min_chunk: payload size of the smallest class.
+  // max_pages: cap on pages for all classes together; 0 means unlimited.
+  explicit Slab_Allocator(std::size_t page_size = 64 * 1024,
+                          double growth_factor = 1.25,
+                          std::size_t min_chunk = 8,
+                          std::size_t max_pages = 0);
+  ~Slab_Allocator();
+
+  Slab_Allocator(const Slab_Allocator&) = delete;
+  Slab_Allocator& operator=(const Slab_Allocator&) = delete;
+
+  // Cap the pages at 'bytes' worth, plus one per class for the partly
+  // filled page each may have. Values in the large class aren't counted.
+  void set_budget(std::size_t bytes);
+
+  // Return space for 'length' bytes, or nullptr if the page cap prevents it
+  // or 'length' is over MAX_LENGTH.
+  // The chunk is placed at the most-recently-used end of its class's LRU.
+  // 'owner' is an opaque cookie handed back by lru_victim().
+  byte_type* allocate(std::size_t length, void* owner = nullptr);
+
+  // Return a chunk obtained from allocate() to its class's free list.
+  void release(byte_type* data);
+
+  // Take a chunk off its class's LRU without freeing it yet, for values that
+  // have been unlinked but may still be read. Release it later as usual.
+  void detach(byte_type* data);
+
+  // Reference counting for readers that hold on to a chunk after the lock
+  // protecting the allocator is gone. pin() must be called while the chunk is
+  // known to be live; it fails (returns false) if the count would overflow.
+  // unpin() may be called from any thread. Owners must not release a chunk
+  // while pinned() is true.
+  static bool pin(const byte_type* data);
+  static void unpin(const byte_type* data);
+  bool pinned(const byte_type* data) const;
+
+  // Move a chunk to the most-recently-used end of its class's LRU.
+  void touch(byte_type* data);
+
+  // Owner cookie of the least recently used chunk in the class that would
+  // serve an allocation of 'length' bytes, or nullptr if that class is empty.
+  void* lru_victim(std::size_t length) const;
+
+  // Length passed to allocate() for this chunk.
+  std::size_t length(const byte_type* data) const;
+
+  // Bytes of memory an allocation of 'length' bytes takes up, header and
+  // rounding included.
+  std::size_t footprint(std::size_t length) const;
+
+  // Class index an allocation of 'length' bytes lands in. The last index is
+  // the "large" class: values too big for a page get a dedicated allocation.
+  std::size_t class_for(std::size_t length) const;
+  std::size_t num_classes() const;
+
+  std::vector<Class_Stats> stats() const;
+
+  // Bytes held from the system, including unused chunks and chunk headers.
+  std::size_t reserved() const;
+
+  // Free every page and forget every chunk.
+  void clear();
+
+ private:
+  struct Chunk;
+  struct Slab_Class;
+
+  static Chunk* header(const byte_type* data);
+  bool grow(Slab_Class& cls);
+  void lru_unlink(Slab_Class& cls, Chunk* chunk);
+  void lru_push(Slab_Class& cls, Chunk* chunk);
+
+  std::size_t page_size_;
+  std::size_t max_pages_;
+  std::size_t pages_ = 0;
+  std::size_t large_bytes_ = 0;
+  std::vector<Slab_Class> classes_;
+};
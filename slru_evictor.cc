@@ -0,0 +1,104 @@
+/*
+ * Implementation of the SLRU_Evictor declared in slru_evictor.hh.
+ */
+
+#include "slru_evictor.hh"
+#include <cassert>
+
+SLRU_Evictor::SLRU_Evictor(double protected_ratio)
+    : protected_ratio_(protected_ratio)
+{
+    assert(protected_ratio >= 0 && protected_ratio <= 1 && "Protected share must be within [0, 1]");
+}
+
+void
+SLRU_Evictor::unlink(uint32_t n)
+{
+    Node& node = nodes_[n];
+    List& list = lists_[node.segment];
+    if (node.prev == NIL) list.head = node.next;
+    else nodes_[node.prev].next = node.next;
+    if (node.next == NIL) list.tail = node.prev;
+    else nodes_[node.next].prev = node.prev;
+    --list.size;
+}
+
+void
+SLRU_Evictor::push_back(Segment segment, uint32_t n)
+{
+    List& list = lists_[segment];
+    Node& node = nodes_[n];
+    node.segment = segment;
+    node.prev = list.tail;
+    node.next = NIL;
+    if (list.tail == NIL) list.head = n;
+    else nodes_[list.tail].next = n;
+    list.tail = n;
+    ++list.size;
+}
+
+void
+SLRU_Evictor::touch_key(const key_type& key)
+// New keys go on probation; a touch on probation earns protection
+{
+    std::size_t hash = nodes_.hash(key);
+    uint32_t n = nodes_.find(key, hash);
+    if (n == NIL) {
+        push_back(PROBATION, nodes_.insert(key, hash));
+        return;
+    }
+    unlink(n);
+    push_back(PROTECTED, n);
+    List& prot = lists_[PROTECTED];
+    if (prot.size > protected_ratio_ * nodes_.size()) {
+        uint32_t demoted = prot.head;
+        unlink(demoted);
+        push_back(PROBATION, demoted);
+    }
+}
+
+uint32_t
+SLRU_Evictor::victim() const
+// Least recently used key on probation, or in the protected segment if
+// probation is empty
+{
+    const List& list = lists_[PROBATION].head != NIL ? lists_[PROBATION] : lists_[PROTECTED];
+    return list.head;
+}
+
+const key_type
+SLRU_Evictor::evict()
+{
+    uint32_t n = victim();
+    if (n == NIL) {
+        return "";
+    }
+    unlink(n);
+    key_type k = nodes_[n].key;
+    nodes_.erase(n);
+    return k;
+}
+
+const key_type
+SLRU_Evictor::peek_victim()
+{
+    uint32_t n = victim();
+    return n == NIL ? "" : nodes_[n].key;
+}
+
+void
+SLRU_Evictor::forget_key(const key_type& key)
+{
+    uint32_t n = nodes_.find(key, nodes_.hash(key));
+    if (n != NIL) {
+        unlink(n);
+        nodes_.erase(n);
+    }
+}
+
+void
+SLRU_Evictor::clear()
+{
+    nodes_.clear();
+    lists_[PROBATION] = lists_[PROTECTED] = List();
+}
@@ -0,0 +1,71 @@
+/*
+ * Declarations for a Segmented LRU (SLRU) eviction policy according to the pattern in evictor.hh.
+ * Implemented in slru_evictor.cc.
+ *
+ * Keys start in a probationary LRU segment. A key touched again while on
+ * probation has shown it is reused and moves to the protected segment.
+ * Victims come from the probationary segment, so keys that are only seen
+ * once, such as those of a bulk scan, pass through without disturbing the
+ * protected working set. When the protected segment outgrows its share of
+ * the keys, its least recently used key drops back to the most recently used
+ * end of probation, where another touch saves it again. This is the same
+ * idea as 2Q's A1in/Am split, with LRU order in both segments.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "evictor.hh"
+#include "key_table.hh"
+
+class SLRU_Evictor final : public Evictor {
+private:
+    enum Segment : uint8_t { PROBATION, PROTECTED };
+
+    struct Node {
+        key_type key;
+        std::size_t hash;
+        uint32_t prev;  // Towards the least recently used end
+        uint32_t next;  // Towards the most recently used end
+        Segment segment;
+    };
+    using Table = Key_Table<Node>;
+    static constexpr uint32_t NIL = Table::NIL;
+
+    struct List {
+        uint32_t head = NIL;    // Least recently used
+        uint32_t tail = NIL;    // Most recently used
+        std::size_t size = 0;
+    };
+
+    Table nodes_;
+    List lists_[2];
+    double protected_ratio_;
+
+    void unlink(uint32_t n);
+    void push_back(Segment segment, uint32_t n);
+    uint32_t victim() const;
+
+public:
+    // protected_ratio: share of the tracked keys the protected segment may
+    // hold before demoting to probation, between 0 and 1. 0 makes this a
+    // plain LRU.
+    explicit SLRU_Evictor(double protected_ratio = 0.8);
+    SLRU_Evictor(const SLRU_Evictor&) = delete;
+    SLRU_Evictor& operator=(const SLRU_Evictor&) = delete;
+
+    void touch_key(const key_type&) override;
+    const key_type evict() override;
+    const key_type peek_victim() override;
+    bool empty() const override { return size() == 0; }
+    uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                         std::vector<key_type>& victims) override {
+        return evict_bytes_of(*this, bytes, size_of, victims);
+    }
+    void forget_key(const key_type&) override;
+    void clear() override;
+
+    // Number of keys currently tracked, and how many of them are protected
+    std::size_t size() const { return nodes_.size(); }
+    std::size_t protected_size() const { return lists_[PROTECTED].size; }
+};
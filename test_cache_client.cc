@@ -83,7 +83,6 @@ void test_reduction() {
     // Verify that it was not rejected
     cache_get(items, "ItemA", gotItemSize, 4);
     cache_reset(items);
-    items.~Cache();
 }
 
 void test_basic_operation() {
@@ -104,7 +103,6 @@ void test_basic_operation() {
     cache_set(items, "Bc", "ItemB", 3);
     cache_reset(items);
     cache_space_used(items, 0);
-    items.~Cache();
 }
 
 void test_modify_value() {
@@ -118,7 +116,6 @@ void test_modify_value() {
     cache_space_used(items, 3);
     cache_get(items, "ItemA", gotItemSize, 3);
     cache_reset(items);
-    items.~Cache();
 }
 
 void test_set_object_cache_size() {
@@ -132,7 +129,6 @@ void test_set_object_cache_size() {
     // Check that it worked
     cache_space_used(items, 10);
     cache_reset(items);
-    items.~Cache();
 }
 
 void test_cache_bounds() {
@@ -142,7 +138,6 @@ void test_cache_bounds() {
     cache_set(items, "Abcdefghij", "ItemA", 11);
     cache_space_used(items, 0);
     cache_reset(items);
-    items.~Cache();
 }
 
 void test_overflow_no_evictor() {
@@ -154,7 +149,6 @@ void test_overflow_no_evictor() {
     cache_set(items, "Cde", "ItemC", 4);
     cache_space_used(items, 8);
     cache_reset(items);
-    items.~Cache();
 }
 
 void test_get_non_existant_item() {
@@ -171,7 +165,6 @@ void test_get_non_existant_item() {
     cache_get_failure(items, "ItemA", gotItemSize);
     cache_space_used(items, 0);
     cache_reset(items);
-    items.~Cache();
 }
 /*
 // TESTS WITH AN EVICTOR
@@ -191,8 +184,6 @@ void test_basic_evictor() {
     cache_space_used(items, 10);
     cache_get_failure(items, "ItemA", gotItemSize);
     cache_get_failure(items, "ItemD", gotItemSize);
-    evictPolicy.~FIFO_Evictor();
-    items.~Cache();
 }
 
 void test_cache_bounds_with_evictor() {
@@ -211,8 +202,6 @@ void test_cache_bounds_with_evictor() {
     // Check if any items were evicted unnecessarily
     cache_get(items, "ItemB", gotItemSize, 3);
     cache_get(items, "ItemC", gotItemSize, 4);
-    evictPolicy.~FIFO_Evictor();
-    items.~Cache();
 }
 
 void test_unnecessary_eviction()
@@ -232,8 +221,6 @@ void test_unnecessary_eviction()
     cache_set(items, "Cdefgh", "ItemC", 7);
     cache_space_used(items, 10);
     cache_get(items, "ItemB", gotItemSize, 3);
-    evictPolicy.~FIFO_Evictor();
-    items.~Cache();
 }
 
 void test_eviction() {
@@ -250,7 +237,6 @@ void test_eviction() {
     assert(evictedKey == "ItemB" && "Evicted key did not match expectation!");
     evictedKey = evictPolicy.evict();
     assert(evictedKey == "ItemA" && "Evicted key did not match expectation!");
-    evictPolicy.~FIFO_Evictor();
 }
 
 void test_evict_all() {
@@ -272,8 +258,6 @@ void test_evict_all() {
     cache_get_failure(items, "ItemB", gotItemSize);
     cache_get_failure(items, "ItemC", gotItemSize);
     cache_get(items, "ItemD", gotItemSize, 10);
-    evictPolicy.~FIFO_Evictor();
-    items.~Cache();
 }
 
 void test_size_zero_does_not_evict() {
@@ -294,8 +278,6 @@ void test_size_zero_does_not_evict() {
     cache_get(items, "ItemA", gotItemSize, 4); // Our code fails at this line
     cache_get(items, "ItemB", gotItemSize, 3);
     cache_get(items, "ItemC", gotItemSize, 3);
-    evictPolicy.~FIFO_Evictor();
-    items.~Cache();
 }
 */
 int main()
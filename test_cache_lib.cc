@@ -1,7 +1,28 @@
 #include <cassert>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "cache.hh"
 #include "fifo_evictor.hh"
+#include "slab_allocator.hh"
+#include "hash_index.hh"
+#include "basic_cache.hh"
+#include "sharded_cache.hh"
+#include "lru_evictor.hh"
+#include "clock_evictor.hh"
+#include "clock_pro_evictor.hh"
+#include "slru_evictor.hh"
+#include "arc_evictor.hh"
+#include "s3fifo_evictor.hh"
+#include "lfu_evictor.hh"
+#include "gdsf_evictor.hh"
+#include "sampled_lru_evictor.hh"
+#include "tinylfu_evictor.hh"
+#include "epoch.hh"
+#include "timing_wheel.hh"
+#include "key_filter.hh"
+#include <cstring>
 
 /*
 
@@ -84,7 +105,6 @@ void test_basic_operation() {
     cache_set(items, "Bc", "ItemB", 3);
     cache_reset(items);
     cache_space_used(items, 0);
-    items.~Cache();
 }
 
 void test_modify_value() {
@@ -97,7 +117,6 @@ void test_modify_value() {
     cache_set(items, "Ab", "ItemA", 3);
     cache_space_used(items, 3);
     cache_get(items, "ItemA", gotItemSize, 3);
-    items.~Cache();
 }
 
 void test_reduction() {
@@ -113,7 +132,6 @@ void test_reduction() {
     cache_set(items, "A", "ItemA", 2);
     // Verify that it was not rejected
     cache_get(items, "ItemA", gotItemSize, 2);
-    items.~Cache();
 }
 
 void test_set_object_cache_size() {
@@ -124,7 +142,6 @@ void test_set_object_cache_size() {
     cache_set(items, "Abcdefghi", "ItemA", 10);
     // Check that it worked
     cache_space_used(items, 10);
-    items.~Cache();
 }
 
 void test_cache_bounds() {
@@ -133,7 +150,6 @@ void test_cache_bounds() {
     Cache items(10);
     cache_set(items, "Abcdefghij", "ItemA", 11);
     cache_space_used(items, 0);
-    items.~Cache();
 }
 
 void test_overflow_no_evictor() {
@@ -145,7 +161,6 @@ void test_overflow_no_evictor() {
     cache_set(items, "Cde", "ItemC", 4);
   
     cache_space_used(items, 8);
-    items.~Cache();
 }
 
 void test_get_non_existant_item() {
@@ -161,8 +176,995 @@ void test_get_non_existant_item() {
     cache_del(items, "ItemA");
     cache_get_failure(items, "ItemA", gotItemSize);
     cache_space_used(items, 0);
-    items.~Cache();
 }
+void test_memory_used() {
+    std::cout << "\nTesting memory_used...\n";
+    Cache items(100);
+    assert(items.memory_used() < 4096 && "Empty cache should hold no value storage\n");
+    cache_set(items, "Abcd", "ItemA", 5);
+    cache_set(items, "Bc", "ItemB", 3);
+    // Real footprint includes keys, entries and arena space on top of the values
+    assert(items.memory_used() > items.space_used());
+    // Overwrites and deletes reuse arena space rather than growing it
+    std::size_t before = items.memory_used();
+    cache_set(items, "Efgh", "ItemA", 5);
+    cache_del(items, "ItemB");
+    cache_set(items, "Cd", "ItemB", 3);
+    assert(items.memory_used() == before);
+    cache_reset(items);
+    assert(items.memory_used() < 4096);
+}
+
+void test_hash_index() {
+    std::cout << "\nTesting hash index...\n";
+    // A terrible hasher, so every key collides on its way in
+    using Weak_Index = Hash_Index<int, std::function<std::size_t(std::string_view)>>;
+    Weak_Index index([](std::string_view) { return std::size_t(7); }, 0.5);
+    std::vector<Weak_Index::value_type*> nodes;
+    for (int i = 0; i < 100; ++i) {
+        nodes.push_back(index.insert("key" + std::to_string(i), i));
+    }
+    assert(index.size() == 100 && index.capacity() * 0.5 >= 100);
+    for (int i = 0; i < 100; ++i) {
+        auto node = index.find("key" + std::to_string(i));
+        assert(node == nodes[i] && node->second == i);
+    }
+    assert(index.find("key100") == nullptr);
+    // Churn through erases and inserts; nodes that stay never move
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 50; ++i) {
+            index.erase(index.find("key" + std::to_string(i)));
+        }
+        assert(index.find("key0") == nullptr && index.find("key50") == nodes[50]);
+        for (int i = 0; i < 50; ++i) {
+            nodes[i] = index.insert("key" + std::to_string(i), i + round);
+        }
+    }
+    assert(index.size() == 100 && index.find("key99") == nodes[99]);
+    // Growth is spread over later operations; meanwhile both tables are searched
+    std::size_t rehashes = index.rehashes();
+    int next = 100;
+    while (index.rehashes() == rehashes) {
+        nodes.push_back(index.insert("key" + std::to_string(next), next));
+        ++next;
+    }
+    assert(index.rehash_pending() > 0);
+    for (int i = 0; i < next; ++i) {
+        assert(index.find("key" + std::to_string(i)) == nodes[i]);
+    }
+    while (index.rehash_pending() > 0) {
+        index.erase(index.find("key" + std::to_string(--next)));
+    }
+    assert(index.size() == std::size_t(next) && index.find("key0") == nodes[0]);
+    std::size_t seen = 0;
+    index.for_each([&](Weak_Index::value_type&) { ++seen; });
+    assert(seen == std::size_t(next));
+    index.clear();
+    assert(index.empty() && index.find("key1") == nullptr);
+
+    // A load factor so low that inserts outrun the migration still works
+    Hash_Index<int> sparse(Fast_Hash(), 0.01);
+    for (int i = 0; i < 1000; ++i) {
+        sparse.insert(std::to_string(i), i);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        assert(sparse.find(std::to_string(i))->second == i);
+    }
+}
+
+struct Wheel_Node {
+    int id;
+    uint64_t deadline;
+    Wheel_Hook<Wheel_Node> hook;
+};
+struct Wheel_Hook_Of {
+    Wheel_Hook<Wheel_Node>& operator()(Wheel_Node& node) const { return node.hook; }
+};
+
+void test_timing_wheel() {
+    std::cout << "\nTesting timing wheel...\n";
+    Timing_Wheel<Wheel_Node, Wheel_Hook_Of> wheel;
+    // Deadlines on every level, and one beyond the wheel's reach
+    std::vector<Wheel_Node> nodes;
+    for (uint64_t deadline : { 1ULL, 5ULL, 63ULL, 64ULL, 65ULL, 4099ULL, 300000ULL,
+                               20000000ULL, 1073741900ULL }) {
+        nodes.push_back(Wheel_Node{ int(nodes.size()), deadline, {} });
+    }
+    for (auto& node : nodes) {
+        wheel.schedule(node, node.deadline);
+    }
+    wheel.cancel(nodes[2]);
+    assert(wheel.size() == nodes.size() - 1 && nodes[2].hook.deadline == 0);
+    // Every node expires on its own tick, however far it had to cascade
+    std::vector<int> fired;
+    auto expire = [&](Wheel_Node& node) {
+        assert(node.hook.deadline == 0 && wheel.now() == node.deadline);
+        fired.push_back(node.id);
+    };
+    std::size_t expired = wheel.advance(4, 100, expire);
+    assert(expired == 1);
+    expired = wheel.advance(64, 100, expire);
+    assert(expired == 2);
+    expired = wheel.advance(299999, 100, expire);
+    assert(expired == 2);
+    expired = wheel.advance(2000000000, 100, expire);
+    assert(expired == 3);
+    assert((fired == std::vector<int>{ 0, 1, 3, 4, 5, 6, 7, 8 }));
+    assert(wheel.size() == 0);
+
+    // A budget leaves the rest of a slot for the next call, and a deadline
+    // already past expires on the next advance
+    std::vector<Wheel_Node> batch(10);
+    for (auto& node : batch) {
+        node.deadline = wheel.now() + 3;
+        wheel.schedule(node, node.deadline);
+    }
+    auto count = [](Wheel_Node&) {};
+    expired = wheel.advance(wheel.now() + 5, 4, count);
+    assert(expired == 4);
+    expired = wheel.advance(wheel.now(), 4, count);
+    assert(expired == 4);
+    expired = wheel.advance(wheel.now(), 4, count);
+    assert(expired == 2);
+    Wheel_Node late{ 0, 0, {} };
+    wheel.schedule(late, 1);
+    expired = wheel.advance(wheel.now(), 4, count);
+    assert(expired == 1 && wheel.size() == 0);
+}
+
+void test_key_filter() {
+    std::cout << "\nTesting key filter...\n";
+    Key_Filter filter(1000);
+    Fast_Hash hasher;
+    for (int i = 0; i < 1000; ++i) {
+        filter.add(hasher("Key" + std::to_string(i)));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        assert(filter.may_contain(hasher("Key" + std::to_string(i))));
+    }
+    int false_positives = 0;
+    for (int i = 0; i < 10000; ++i) {
+        false_positives += filter.may_contain(hasher("Other" + std::to_string(i)));
+    }
+    std::cout << "False positive rate when full: " << false_positives / 10000.0 << "\n";
+    assert(false_positives < 500);
+    // Removing keys forgets them, but never the keys still present
+    for (int i = 0; i < 1000; i += 2) {
+        filter.remove(hasher("Key" + std::to_string(i)));
+    }
+    int forgotten = 0;
+    for (int i = 0; i < 1000; ++i) {
+        bool present = filter.may_contain(hasher("Key" + std::to_string(i)));
+        assert(present || i % 2 == 0);
+        forgotten += !present;
+    }
+    assert(forgotten > 400);
+    filter.clear();
+    assert(!filter.may_contain(hasher("Key1")));
+}
+
+void test_slab_allocator() {
+    std::cout << "\nTesting slab allocator...\n";
+    Slab_Allocator slab(4096, 1.25, 8, 2);
+    // Small values share a class; a freed chunk is reused for the next one
+    int a = 1, b = 2;
+    char* first = slab.allocate(5, &a);
+    char* second = slab.allocate(7, &b);
+    assert(slab.class_for(5) == slab.class_for(7));
+    assert(slab.length(first) == 5 && slab.length(second) == 7);
+    slab.release(first);
+    char* third = slab.allocate(6, &a);
+    assert(third == first && "Free list was not reused\n");
+    // The class LRU reports the least recently used owner
+    assert(slab.lru_victim(6) == &b);
+    slab.touch(second);
+    assert(slab.lru_victim(6) == &a);
+    // Values too big for a page go to the large class
+    char* big = slab.allocate(10000);
+    assert(slab.class_for(10000) == slab.num_classes() - 1);
+    auto stats = slab.stats();
+    auto& small = stats[slab.class_for(6)];
+    assert(small.used_chunks == 2 && small.pages == 1);
+    assert(small.fragmentation() > 0. && small.fragmentation() < 1.);
+    assert(stats.back().used_chunks == 1);
+    slab.release(big);
+    // With the page cap reached, allocations in a new class fail
+    slab.allocate(100);
+    char* refused = slab.allocate(1000);
+    assert(refused == nullptr);
+    slab.clear();
+    assert(slab.reserved() == 0);
+}
+
+void test_slab_budget() {
+    std::cout << "\nTesting slab page budget...\n";
+    // Values charged far less than they take run out of pages before maxmem
+    Cache items(100000);
+    std::string value(1000, 'x');
+    Cache::size_type size = 0;
+    for (int i = 0; i < 20000; ++i) {
+        items.set("Key" + std::to_string(i), value, 1);
+        bool hit = items.get("Key0", size) != nullptr;
+        assert(hit);
+    }
+    // The least recently used values of the class made room
+    cache_get_failure(items, "Key1", size);
+    Cache::val_type last = items.get("Key19999", size);
+    assert(last != nullptr && size == 1);
+    auto stats = items.stats();
+    assert(stats["slab_evictions"] > 0);
+    assert(items.memory_used() < 20000 * value.size());
+}
+
+void test_stats() {
+    std::cout << "\nTesting stats...\n";
+    Cache items(100);
+    cache_set(items, "Abcd", "ItemA", 5);
+    cache_set(items, "Bc", "ItemB", 3);
+    Cache::stats_type stats = items.stats();
+    assert(stats["entries"] == 2);
+    assert(stats["space_used"] == 8);
+    bool found_class = false;
+    for (auto& stat : stats) {
+        if (stat.first.find(".used_chunks") != std::string::npos && stat.second == 2) {
+            found_class = true;
+        }
+    }
+    assert(found_class && "Both values should share one slab class\n");
+}
+
+void test_get_shared() {
+    std::cout << "\nTesting get_shared...\n";
+    LRU_Evictor evictPolicy;
+    Cache items(10, 0.75, &evictPolicy);
+    cache_set(items, "Abc", "ItemA", 4);
+    cache_set(items, "Bc", "ItemB", 3);
+    Cache::size_type size = 0;
+    {
+        Epoch_Guard pin;
+        Cache::val_type val = items.get_shared("ItemA", size);
+        assert(val != nullptr && size == 4);
+        Cache::val_type missing = items.get_shared("ItemC", size);
+        assert(missing == nullptr);
+        // Overwriting doesn't free the bytes a pinned reader is looking at
+        cache_set(items, "Xyz", "ItemA", 4);
+        assert(std::strcmp(val, "Abc") == 0);
+        assert(items.stats()["retired_chunks"] == 1);
+    }
+    // Once unpinned, the next write hands the old chunk back to the slab
+    // (leaving only the chunk that write itself retired)
+    cache_del(items, "ItemB");
+    assert(items.stats()["retired_chunks"] == 1);
+    // A shared hit still counts as recent use, so making room for C evicts B
+    cache_set(items, "Bc", "ItemB", 3);
+    items.get_shared("ItemA", size);
+    cache_set(items, "Cdef", "ItemC", 5);
+    cache_get_failure(items, "ItemB", size);
+    cache_get(items, "ItemA", size, 4);
+
+    // Reset leaves a pinned reader's bytes alone rather than wait for it, so
+    // a reader blocked on a lock the resetting thread holds can't stall it
+    std::mutex lock;
+    std::unique_lock<std::mutex> held(lock);
+    std::atomic<bool> pinned{false};
+    std::thread reader([&] {
+        Epoch_Guard pin;
+        Cache::size_type length = 0;
+        Cache::val_type val = items.get_shared("ItemA", length);
+        pinned = true;
+        std::lock_guard<std::mutex> wait(lock);
+        assert(std::strcmp(val, "Xyz") == 0);
+    });
+    while (!pinned) {
+        std::this_thread::yield();
+    }
+    cache_reset(items);
+    held.unlock();
+    reader.join();
+    cache_get_failure(items, "ItemA", size);
+}
+
+void test_get_handle() {
+    std::cout << "\nTesting get handles...\n";
+    LRU_Evictor evictPolicy;
+    Cache items(10, 0.75, &evictPolicy);
+    cache_set(items, "Abc", "ItemA", 4);
+    Cache::Value_Handle missing = items.get("ItemC");
+    assert(!missing);
+    Cache::Value_Handle handle = items.get("ItemA");
+    assert(handle && handle.size() == 4 && handle.length() == 3);
+    assert(std::strcmp(handle.data(), "Abc") == 0);
+    // The handle keeps the old bytes alive through an overwrite and a delete
+    cache_set(items, "Xyz", "ItemA", 4);
+    cache_del(items, "ItemA");
+    assert(std::strcmp(handle.data(), "Abc") == 0);
+    assert(items.stats()["retired_chunks"] >= 1);
+    // Moving hands over the reference; dropping it lets the chunk go
+    Cache::Value_Handle moved = std::move(handle);
+    assert(!handle && moved);
+    moved.reset();
+    cache_set(items, "Bc", "ItemB", 3);
+    assert(items.stats()["retired_chunks"] == 0);
+}
+
+void test_binary_values() {
+    std::cout << "\nTesting binary values...\n";
+    Cache items(100);
+    const std::string blob("a\0b\0c", 5);
+    items.set(std::string_view("Blob"), std::string_view(blob), 5);
+    Cache::Value_Handle handle = items.get("Blob");
+    assert(handle && handle.length() == 5 && handle.size() == 5);
+    assert(std::string(handle.data(), handle.length()) == blob);
+    handle.reset();
+    // The rvalue overload takes over the key and stores the whole value too
+    std::string key("Moved"), val(blob);
+    items.set(std::move(key), std::move(val), 5);
+    assert(items.space_used() == 10);
+    Cache::size_type size = 0;
+    Cache::val_type got = items.get("Moved", size);
+    assert(got != nullptr && items.stored_length(got) == 5);
+    assert(std::string(got, items.stored_length(got)) == blob);
+    cache_del(items, "Blob");
+    Cache::Value_Handle gone = items.get("Blob");
+    assert(!gone);
+
+    ShardedCache shards(2, 100);
+    shards.set(std::string_view("Blob"), std::string_view(blob), 5);
+    std::string copy;
+    bool found = shards.get("Blob", copy, size);
+    assert(found && copy == blob && size == 5);
+}
+
+void test_basic_cache() {
+    std::cout << "\nTesting BasicCache...\n";
+    LRU_Evictor evictPolicy;
+    BasicCache<Fast_Hash, LRU_Evictor> items(10, 0.75, &evictPolicy);
+    Cache::size_type size = 0;
+    items.set("ItemA", "Abc", 4);
+    items.set("ItemB", "Bc", 3);
+    Cache::val_type val = items.get("ItemA", size);
+    assert(std::strcmp(val, "Abc") == 0 && size == 4);
+    // ItemB is least recently used, so it makes room for ItemC
+    items.set("ItemC", "Cdef", 5);
+    val = items.get("ItemB", size);
+    assert(val == nullptr);
+    Cache::Value_Handle handle = items.get("ItemA");
+    assert(handle && items.space_used() == 9);
+    handle.reset();
+    bool deleted = items.del("ItemA");
+    assert(deleted && items.space_used() == 5);
+
+    // Fast_Hash sees every byte, including NULs, and depends on the seed
+    Fast_Hash hash;
+    assert(hash(std::string("a\0b", 3)) != hash(std::string("a\0c", 3)));
+    assert(hash("key") == Fast_Hash()("key") && hash("key") != Fast_Hash(1)("key"));
+    std::string long_key(100, 'x');
+    std::size_t before = hash(long_key);
+    long_key[50] = 'y';
+    assert(hash(long_key) != before);
+}
+
+void test_clock_evictors() {
+    std::cout << "\nTesting CLOCK evictors in a cache...\n";
+    Clock_Evictor evictPolicy;
+    Cache items(10, 0.75, &evictPolicy);
+    cache_set(items, "Abc", "ItemA", 4);
+    cache_set(items, "Bc", "ItemB", 3);
+    // A shared read marks ItemA in the evictor right away, so ItemB goes
+    Cache::Value_Handle handle = items.get("ItemA");
+    assert(handle);
+    handle.reset();
+    cache_set(items, "Cdef", "ItemC", 5);
+    Cache::size_type size = 0;
+    cache_get_failure(items, "ItemB", size);
+    cache_get(items, "ItemA", size, 4);
+    cache_get(items, "ItemC", size, 5);
+
+    // Readers on several threads marking at once, under the shard locks
+    ShardedCache sharded(2, 2000, 0.75,
+        [] { return std::unique_ptr<Evictor>(new Clock_Pro_Evictor()); });
+    for (int i = 0; i < 100; ++i) {
+        sharded.set("Key" + std::to_string(i), "Abcd", 5);
+    }
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&sharded] {
+            for (int n = 0; n < 1000; ++n) {
+                Cache::Value_Handle hit = sharded.get("Key" + std::to_string(n % 50));
+                assert(hit);
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    // Room for 400 values: a scan of 1000 new keys leaves the read ones alone
+    for (int i = 0; i < 1000; ++i) {
+        sharded.set("Scan" + std::to_string(i), "Abcd", 5);
+    }
+    for (int i = 0; i < 50; ++i) {
+        Cache::Value_Handle hit = sharded.get("Key" + std::to_string(i));
+        assert(hit);
+    }
+}
+
+void test_slru_cache() {
+    std::cout << "\nTesting SLRU evictor in a cache...\n";
+    SLRU_Evictor evictPolicy;
+    Cache items(9, 0.75, &evictPolicy);
+    Cache::size_type size = 0;
+    cache_set(items, "Ab", "ItemA", 3);
+    cache_set(items, "Bc", "ItemB", 3);
+    cache_set(items, "Cd", "ItemC", 3);
+    // ItemA is reused, so it's protected; a scan only cycles probation
+    cache_get(items, "ItemA", size, 3);
+    cache_set(items, "Sa", "Scan1", 3);
+    cache_set(items, "Sb", "Scan2", 3);
+    cache_set(items, "Sc", "Scan3", 3);
+    cache_get(items, "ItemA", size, 3);
+    cache_get_failure(items, "ItemB", size);
+    cache_get_failure(items, "ItemC", size);
+    cache_get_failure(items, "Scan1", size);
+}
+
+void test_fifo_caches() {
+    std::cout << "\nTesting FIFO and S3-FIFO evictors in a cache...\n";
+    FIFO_Evictor evictPolicy;
+    Cache items(9, 0.75, &evictPolicy);
+    Cache::size_type size = 0;
+    // Overwrites keep ItemA in its first place, and queue nothing new
+    for (int i = 0; i < 100; ++i) {
+        cache_set(items, "Ab", "ItemA", 3);
+    }
+    cache_set(items, "Bc", "ItemB", 3);
+    cache_set(items, "Cd", "ItemC", 3);
+    cache_get(items, "ItemA", size, 3);
+    cache_del(items, "ItemB");
+    // ItemB's stale entry is passed over, then ItemA goes despite its hit
+    cache_set(items, "De", "ItemD", 3);
+    cache_set(items, "Ef", "ItemE", 3);
+    cache_get_failure(items, "ItemA", size);
+    cache_get(items, "ItemC", size, 3);
+    cache_get(items, "ItemD", size, 3);
+    cache_get(items, "ItemE", size, 3);
+
+    // A key the evictor knew before the cache did frees nothing, so only
+    // ItemA counts as an eviction
+    FIFO_Evictor seeded;
+    seeded.touch_key("Ghost");
+    Cache fresh(6, 0.75, &seeded);
+    cache_set(fresh, "Ab", "ItemA", 3);
+    cache_set(fresh, "Bc", "ItemB", 3);
+    cache_set(fresh, "Cd", "ItemC", 3);
+    cache_get_failure(fresh, "ItemA", size);
+    assert(fresh.stats()["evictions"] == 1);
+
+    // Gets mark the key right away; a key read in the small queue survives
+    // a scan, as in the SLRU test
+    S3FIFO_Evictor s3fifo;
+    Cache scanned(9, 0.75, &s3fifo);
+    cache_set(scanned, "Ab", "ItemA", 3);
+    cache_set(scanned, "Bc", "ItemB", 3);
+    cache_set(scanned, "Cd", "ItemC", 3);
+    cache_get(scanned, "ItemA", size, 3);
+    cache_set(scanned, "Sa", "Scan1", 3);
+    cache_set(scanned, "Sb", "Scan2", 3);
+    cache_set(scanned, "Sc", "Scan3", 3);
+    cache_get(scanned, "ItemA", size, 3);
+    cache_get_failure(scanned, "ItemB", size);
+    cache_get_failure(scanned, "ItemC", size);
+    Cache::stats_type stats = scanned.stats();
+    assert(stats["evictor.s3fifo_main"] == 1 && stats["evictor.s3fifo_ghost"] >= 1);
+}
+
+void test_lfu_cache() {
+    std::cout << "\nTesting LFU evictor in a cache...\n";
+    LFU_Evictor evictPolicy;
+    Cache items(9, 0.75, &evictPolicy);
+    Cache::size_type size = 0;
+    cache_set(items, "Ab", "ItemA", 3);
+    cache_set(items, "Bc", "ItemB", 3);
+    cache_set(items, "Cd", "ItemC", 3);
+    // Gets reach the evictor with the next write, so ItemA and ItemC
+    // outrank ItemB, and then the new ItemD
+    cache_get(items, "ItemA", size, 3);
+    cache_get(items, "ItemA", size, 3);
+    cache_get(items, "ItemC", size, 3);
+    cache_set(items, "De", "ItemD", 3);
+    cache_get_failure(items, "ItemB", size);
+    cache_set(items, "Ef", "ItemE", 3);
+    cache_get_failure(items, "ItemD", size);
+    cache_get(items, "ItemA", size, 3);
+    cache_get(items, "ItemC", size, 3);
+    assert(items.stats()["evictor.lfu_bytes_per_key"] > 0);
+}
+
+void test_gdsf_cache() {
+    std::cout << "\nTesting GDSF evictor in a cache...\n";
+    GDSF_Evictor evictPolicy;
+    Cache items(130, 0.75, &evictPolicy);
+    Cache::size_type size = 0;
+    std::string big(114, 'b');
+    // Ten small keys, all but the first three read often
+    for (int i = 0; i < 10; ++i) {
+        cache_set(items, "v", "Small" + std::to_string(i), 2);
+    }
+    for (int i = 3; i < 10; ++i) {
+        cache_get(items, "Small" + std::to_string(i), size, 2);
+        cache_get(items, "Small" + std::to_string(i), size, 2);
+    }
+    // The big value needs room for itself, taking the three cold keys
+    cache_set(items, big.c_str(), "Big", 115);
+    cache_get_failure(items, "Small0", size);
+    cache_get_failure(items, "Small2", size);
+    cache_get(items, "Small3", size, 2);
+    // but it is what goes when the next small key comes in, where LRU
+    // would push out Small3
+    cache_set(items, "v", "New", 2);
+    cache_get_failure(items, "Big", size);
+    cache_get(items, "Small3", size, 2);
+    cache_get(items, "New", size, 2);
+}
+
+void test_evictor_notifications() {
+    std::cout << "\nTesting deletes, resets and batch eviction reach the evictor...\n";
+    LRU_Evictor evictPolicy;
+    Cache items(20, 0.75, &evictPolicy);
+    Cache::size_type size = 0;
+    for (int i = 0; i < 10; ++i) {
+        cache_set(items, "v", "Key" + std::to_string(i), 2);
+    }
+    // Deleted keys are forgotten, not left for evict() to hand back
+    cache_del(items, "Key0");
+    cache_del(items, "Key5");
+    assert(evictPolicy.size() == 8);
+    // One large value: a single batch frees the four oldest keys
+    std::string big(12, 'b');
+    cache_set(items, big.c_str(), "Big", 12);
+    assert(evictPolicy.size() == 5);
+    cache_space_used(items, 20);
+    cache_get_failure(items, "Key4", size);
+    cache_get(items, "Key6", size, 2);
+    // Reset empties the evictor too
+    items.reset();
+    key_type leftover = evictPolicy.evict();
+    assert(evictPolicy.size() == 0 && leftover == "");
+    cache_set(items, "v", "After", 2);
+    assert(evictPolicy.size() == 1);
+
+    // "" is a key like any other. As the evictor's last key it is evicted
+    // once, and then the batch stops short instead of asking an empty
+    // evictor for more (here Other's bytes, which it has lost track of).
+    LRU_Evictor emptied;
+    Cache pressed(6, 0.75, &emptied);
+    cache_set(pressed, "o", "Other", 3);
+    cache_set(pressed, "e", "", 3);
+    cache_get(pressed, "", size, 3);
+    emptied.forget_key("Other");
+    cache_set(pressed, "bbbbb", "Big", 6);
+    cache_get_failure(pressed, "", size);
+    cache_get_failure(pressed, "Big", size);
+    cache_get(pressed, "Other", size, 3);
+    cache_space_used(pressed, 3);
+    assert(pressed.stats()["evictions"] == 1);
+}
+
+void test_sampled_lru_cache() {
+    std::cout << "\nTesting sampled LRU evictor in a cache...\n";
+    Sampled_LRU_Evictor evictPolicy(64);
+    Cache items(20, 0.75, &evictPolicy);
+    for (int i = 0; i < 10; ++i) {
+        cache_set(items, "v", "Key" + std::to_string(i), 2);
+    }
+    // Shared reads only stamp the keys, from several threads at once
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&items] {
+            for (int n = 0; n < 1000; ++n) {
+                Cache::Value_Handle hit = items.get("Key" + std::to_string(n % 5));
+                assert(hit);
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    // New keys push out the oldest unread ones
+    for (int i = 0; i < 4; ++i) {
+        cache_set(items, "v", "New" + std::to_string(i), 2);
+    }
+    Cache::size_type size = 0;
+    for (int i = 0; i < 5; ++i) {
+        cache_get(items, "Key" + std::to_string(i), size, 2);
+    }
+    cache_get_failure(items, "Key5", size);
+    cache_get_failure(items, "Key8", size);
+    cache_get(items, "Key9", size, 2);
+}
+
+void test_reader_drains() {
+    std::cout << "\nTesting readers replaying touches themselves...\n";
+    LRU_Evictor evictPolicy;
+    Cache items(20, 0.75, &evictPolicy);
+    for (int i = 0; i < 10; ++i) {
+        cache_set(items, "v", "Key" + std::to_string(i), 2);
+    }
+    // Far more reads than one buffer holds, with no write in between: the
+    // readers replay them into the LRU themselves
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&items] {
+            for (int n = 0; n < 10000; ++n) {
+                Cache::Value_Handle hit = items.get("Key" + std::to_string(n % 5));
+                assert(hit);
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    Cache::stats_type stats = items.stats();
+    assert(stats["reader_drains"] > 0);
+    assert(stats["touches_dropped"] < 40000);
+    // Every read key is now more recent than the unread ones
+    cache_set(items, "v", "New", 2);
+    Cache::size_type size = 0;
+    cache_get_failure(items, "Key5", size);
+    for (int i = 0; i < 5; ++i) {
+        cache_get(items, "Key" + std::to_string(i), size, 2);
+    }
+}
+
+void test_tinylfu_cache() {
+    std::cout << "\nTesting TinyLFU admission in a cache...\n";
+    TinyLFU_Evictor evictPolicy(std::unique_ptr<Evictor>(new LRU_Evictor()));
+    Cache items(200, 0.75, &evictPolicy);
+    Cache::size_type size = 0;
+    for (int i = 0; i < 100; ++i) {
+        cache_set(items, "v", "Hot" + std::to_string(i), 2);
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            cache_get(items, "Hot" + std::to_string(i), size, 2);
+        }
+    }
+    // A scan of keys set once each mostly replaces its own kind; plain LRU
+    // would lose every hot key to it
+    for (int i = 0; i < 500; ++i) {
+        cache_set(items, "v", "Scan" + std::to_string(i), 2);
+    }
+    int hot = 0;
+    for (int i = 0; i < 100; ++i) {
+        hot += items.get("Hot" + std::to_string(i), size) != nullptr;
+    }
+    std::cout << hot << " hot keys survived the scan\n";
+    assert(hot >= 90);
+    Cache::stats_type stats = items.stats();
+    assert(stats["evictor.tinylfu_rejected"] > stats["evictor.tinylfu_admitted"]);
+}
+
+void test_evictor_stats() {
+    std::cout << "\nTesting evictor stats...\n";
+    ARC_Evictor evictPolicy;
+    Cache items(6, 0.75, &evictPolicy);
+    Cache::size_type size = 0;
+    cache_set(items, "Ab", "ItemA", 3);
+    cache_set(items, "Bc", "ItemB", 3);
+    cache_get(items, "ItemA", size, 3);
+    // ItemB is evicted, then comes back while ARC still remembers it
+    cache_set(items, "Cd", "ItemC", 3);
+    cache_set(items, "Bc", "ItemB", 3);
+    // The evictor's counters come out with the cache's, under "evictor."
+    Cache::stats_type stats = items.stats();
+    assert(stats["evictor.arc_b1_hits"] == 1 && stats["evictor.arc_target"] > 0);
+    assert(stats["evictor.arc_t2"] == 2 && stats["evictor.arc_b1"] == 1);
+}
+
+void test_large_sizes() {
+    std::cout << "\nTesting sizes over 4GiB...\n";
+    Cache::size_type gig = 1024 * 1024 * 1024;
+    Cache items(8 * gig);
+    cache_set(items, "Abc", "ItemA", 5 * gig);
+    assert(items.space_used() == 5 * gig);
+    Cache::size_type size = 0;
+    Cache::val_type val = items.get("ItemA", size);
+    assert(std::strcmp(val, "Abc") == 0 && size == 5 * gig);
+    Cache::Value_Handle handle = items.get("ItemA");
+    assert(handle.size() == 5 * gig);
+    handle.reset();
+    // Another 5GiB doesn't fit without an evictor
+    items.set("ItemB", "Bc", 5 * gig);
+    assert(items.space_used() == 5 * gig);
+}
+
+void test_count_overhead() {
+    std::cout << "\nTesting overhead accounting...\n";
+    LRU_Evictor evictPolicy;
+    Cache items(4096, 0.75, &evictPolicy, Fast_Hash(), true);
+    // The size given to set() is ignored; key, chunk and index are charged
+    cache_set(items, "Abc", "ItemA", 1);
+    Cache::size_type one = items.space_used();
+    assert(one > 4 + 5);
+    cache_set(items, "Abc", "ItemB", 1000);
+    assert(items.space_used() == 2 * one);
+    // Overwriting with a longer value charges the bigger chunk
+    cache_set(items, std::string(100, 'x').c_str(), "ItemB", 1);
+    assert(items.space_used() > 2 * one);
+    cache_del(items, "ItemB");
+    assert(items.space_used() == one);
+    // Values stay within maxmem as measured, evicting as needed
+    for (int i = 0; i < 1000; ++i) {
+        items.set("Key" + std::to_string(i), "Abcdefgh", 9);
+        assert(items.space_used() <= 4096);
+    }
+    Cache::size_type size = 0;
+    cache_get_failure(items, "ItemA", size);
+    cache_get(items, "Key999", size, 9);
+}
+
+void test_sharded_cache() {
+    std::cout << "\nTesting sharded cache...\n";
+    ShardedCache items(4, 4000, 0.75,
+        [] { return std::unique_ptr<Evictor>(new LRU_Evictor()); });
+    assert(items.num_shards() == 4);
+    // Several threads setting and reading back their own keys at once
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&items, t] {
+            for (int i = 0; i < 50; ++i) {
+                key_type key = "T" + std::to_string(t) + "K" + std::to_string(i);
+                items.set(key, "Abcd", 5);
+                std::string val;
+                Cache::size_type size = 0;
+                bool found = items.get(key, val, size);
+                assert(found && val == "Abcd" && size == 5);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Cache::size_type used_space = items.space_used();
+    std::cout << "Current memory used: " << used_space << " | Expected: " << 4 * 50 * 5 << "\n";
+    assert(used_space == 4 * 50 * 5);
+    // Readers on one key racing a writer always see a whole value
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&items] {
+            for (int i = 0; i < 2000; ++i) {
+                std::string val;
+                Cache::size_type size = 0;
+                bool found = items.get("T0K1", val, size);
+                assert(found);
+                assert((val == "Abcd" && size == 5) || (val == "Wxyz" && size == 5));
+            }
+        });
+    }
+    for (int i = 0; i < 2000; ++i) {
+        items.set("T0K1", (i % 2) ? "Abcd" : "Wxyz", 5);
+    }
+    for (auto& thread : readers) {
+        thread.join();
+    }
+    std::cout << "Concurrent readers saw only whole values.\n";
+    assert(items.stats()["entries"] == 200);
+    bool deleted = items.del("T0K0");
+    assert(deleted);
+    std::cout << "Deleted T0K0 from the cache.\n";
+    deleted = items.del("T0K0");
+    assert(!deleted);
+    items.reset();
+    std::cout << "Cache reset.\n";
+    assert(items.space_used() == 0);
+}
+
+void test_background_eviction() {
+    std::cout << "\nTesting eviction ahead of sets...\n";
+    LRU_Evictor evictPolicy;
+    Cache items(30, 0.75, &evictPolicy);
+    Cache::size_type size = 0;
+    for (int i = 0; i < 10; ++i) {
+        cache_set(items, "Ab", "Key" + std::to_string(i), 3);
+    }
+    cache_get(items, "Key0", size, 3);
+    // Oldest first, and the read of Key0 counts
+    Cache::size_type freed = items.evict_to(20);
+    assert(freed == 12);
+    cache_get(items, "Key0", size, 3);
+    cache_get_failure(items, "Key1", size);
+    cache_get_failure(items, "Key4", size);
+    cache_get(items, "Key5", size, 3);
+    freed = items.evict_to(20);
+    assert(freed == 0);
+    // The room made ahead means the next sets evict nothing themselves
+    cache_set(items, "Ab", "New0", 3);
+    cache_set(items, "Ab", "New1", 3);
+    Cache::stats_type stats = items.stats();
+    assert(stats["evictions_ahead"] == 4 && stats["bytes_evicted_ahead"] == 12);
+    assert(stats["evictions"] == 0);
+
+    // With the maintenance thread, sets past the high watermark get the
+    // shard evicted down to the low one
+    ShardedCache shards(2, 1000, 0.75,
+        [] { return std::unique_ptr<Evictor>(new LRU_Evictor()); });
+    shards.start_maintenance(0.9, 0.5, std::chrono::milliseconds(5));
+    for (int i = 0; i < 200; ++i) {
+        shards.set("Key" + std::to_string(i), "Abcdefghi", 10);
+    }
+    for (int wait = 0; wait < 1000 && shards.space_used() > 900; ++wait) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(shards.space_used() <= 900);
+    stats = shards.stats();
+    assert(stats["evictions_ahead"] > 0 && stats["maintenance_passes"] > 0);
+    shards.stop_maintenance();
+    shards.stop_maintenance();
+}
+
+void test_ttl() {
+    std::cout << "\nTesting TTLs...\n";
+    LRU_Evictor evictPolicy;
+    Cache items(100, 0.75, &evictPolicy);
+    Cache::size_type size = 0;
+    items.set("Short", "Ab", 3, std::chrono::milliseconds(20));
+    items.set("Long", "Cd", 3, std::chrono::hours(24 * 365));
+    items.set("Cleared", "Ef", 3, std::chrono::milliseconds(20));
+    cache_set(items, "Gh", "Cleared", 3);
+    cache_set(items, "Ij", "Forever", 3);
+    cache_get(items, "Short", size, 3);
+    assert(items.stats()["ttl_entries"] == 2 && items.ttl_entries() == 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    // Expired values miss at once, but hold their space until reclaimed
+    Cache::val_type expired = items.get_shared("Short", size);
+    assert(expired == nullptr);
+    Cache::Value_Handle handle = items.get(std::string_view("Short"));
+    assert(!handle);
+    assert(items.space_used() == 12);
+    cache_get_failure(items, "Short", size);
+    assert(items.space_used() == 9 && items.stats()["expirations"] == 1);
+    cache_get(items, "Long", size, 3);
+    cache_get(items, "Cleared", size, 3);
+
+    // Sets reclaim a few due values each, and expire() the rest
+    for (int i = 0; i < 10; ++i) {
+        items.set("Temp" + std::to_string(i), "Kl", 3, std::chrono::milliseconds(10));
+    }
+    assert(items.space_used() == 39);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    cache_set(items, "Mn", "Next", 3);
+    assert(items.space_used() == 42 - 4 * 3);
+    std::size_t removed = items.expire(4);
+    assert(removed == 4);
+    removed = items.expire(4);
+    assert(removed == 2);
+    removed = items.expire(4);
+    assert(removed == 0);
+    assert(items.space_used() == 12);
+    Cache::stats_type stats = items.stats();
+    assert(stats["expirations"] == 11 && items.ttl_entries() == 1);
+    // The evictor forgot the expired values, so the least recently used
+    // live one makes room
+    cache_set(items, "Op", "Fill", 90);
+    cache_get_failure(items, "Forever", size);
+    cache_get(items, "Long", size, 3);
+
+    // The maintenance thread reclaims expired values nobody asks for
+    ShardedCache shards(2, 1000, 0.75,
+        [] { return std::unique_ptr<Evictor>(new LRU_Evictor()); });
+    shards.start_maintenance(1, 1, std::chrono::milliseconds(5));
+    for (int i = 0; i < 50; ++i) {
+        shards.set("Key" + std::to_string(i), "Abcdefghi", 10, std::chrono::milliseconds(10));
+    }
+    for (int wait = 0; wait < 1000 && shards.space_used() > 0; ++wait) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(shards.space_used() == 0 && shards.stats()["expirations"] == 50);
+}
+
+void test_sharded_reset() {
+    std::cout << "\nTesting sharded reset...\n";
+    ShardedCache shards(2, 100, 0.75,
+        [] { return std::unique_ptr<Evictor>(new LRU_Evictor()); });
+    for (int i = 0; i < 10; ++i) {
+        shards.set("Key" + std::to_string(i), "Abcdefghi", 10);
+    }
+    // A handle taken before the reset keeps its value readable, and holds
+    // back the freeing of the old contents until it's released
+    Cache::Value_Handle handle = shards.get(std::string_view("Key3"));
+    assert(handle && std::string(handle.data(), handle.length()) == "Abcdefghi");
+    shards.reset();
+    Cache::Value_Handle after = shards.get(std::string_view("Key3"));
+    assert(shards.space_used() == 0 && !after);
+    Cache::stats_type stats = shards.stats();
+    assert(stats["entries"] == 0 && stats["resets"] == 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assert(shards.stats()["reset_pending"] > 0);
+    assert(std::string(handle.data(), handle.length()) == "Abcdefghi");
+    handle = Cache::Value_Handle();
+    for (int wait = 0; wait < 1000 && shards.stats()["reset_pending"] > 0; ++wait) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(shards.stats()["reset_pending"] == 0);
+    // The new evictors start empty: filling the cache again only evicts
+    // keys set since the reset
+    for (int i = 0; i < 12; ++i) {
+        shards.set("New" + std::to_string(i), "Abcdefghi", 10);
+    }
+    assert(shards.space_used() <= 100 && shards.stats()["entries"] >= 8);
+    // Resets with readers running alongside
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&shards] {
+            for (int i = 0; i < 2000; ++i) {
+                std::string val;
+                Cache::size_type size = 0;
+                if (shards.get("New" + std::to_string(i % 12), val, size)) {
+                    assert(val == "Abcdefghi" && size == 10);
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 50; ++i) {
+        shards.reset();
+        shards.set("New" + std::to_string(i % 12), "Abcdefghi", 10);
+    }
+    for (auto& thread : readers) {
+        thread.join();
+    }
+}
+
+void test_negative_lookups() {
+    std::cout << "\nTesting lookups for absent keys...\n";
+    LRU_Evictor evictPolicy;
+    Cache items(20000, 0.75, &evictPolicy);
+    {
+        Epoch_Guard pin;
+        assert(!items.may_contain("Key1"));
+    }
+    // The filter grows with the cache and keeps every key present, including
+    // through evictions and deletes of others
+    for (int i = 0; i < 5000; ++i) {
+        items.set("Key" + std::to_string(i), "Abc", 4);
+    }
+    items.del("Key4999");
+    Epoch_Guard pin;
+    int present = 0;
+    for (int i = 0; i < 5000; ++i) {
+        key_type key = "Key" + std::to_string(i);
+        Cache::size_type size = 0;
+        if (items.get_shared(key, size) != nullptr) {
+            assert(items.may_contain(key));
+            ++present;
+        }
+    }
+    assert(present == 4999);
+    // At 4 bytes or more for each of them
+    assert(items.stats()["filter_bytes"] >= 5000 * 4);
+
+    // Requests for a key never set are turned away before the shard lock
+    ShardedCache shards(4, 4000, 0.75,
+        [] { return std::unique_ptr<Evictor>(new LRU_Evictor()); });
+    for (int i = 0; i < 100; ++i) {
+        shards.set("Key" + std::to_string(i), "Abc", 4);
+    }
+    std::string val;
+    Cache::size_type size = 0;
+    for (int i = 0; i < 1000; ++i) {
+        bool found = shards.get("-A", val, size);
+        assert(!found);
+        Cache::Value_Handle handle = shards.get(std::string_view("Missing" + std::to_string(i)));
+        assert(!handle);
+        bool deleted = shards.del("Missing" + std::to_string(i));
+        assert(!deleted);
+    }
+    bool found = shards.get("Key7", val, size);
+    assert(found && val == "Abc");
+    Cache::stats_type stats = shards.stats();
+    std::cout << "Filter false positive rate: " << stats["filter_false_positive_rate"] << "\n";
+    assert(stats["filter_rejects"] + stats["filter_false_positives"] == 3000);
+    assert(stats["filter_false_positive_rate"] < 0.1);
+}
+
 /*
 // TESTS WITH AN EVICTOR
 void test_basic_evictor() {
@@ -181,8 +1183,6 @@ void test_basic_evictor() {
     cache_space_used(items, 10);
     cache_get_failure(items, "ItemA", gotItemSize);
     cache_get_failure(items, "ItemD", gotItemSize);
-    evictPolicy.~FIFO_Evictor();
-    items.~Cache();
 }
 
 void test_cache_bounds_with_evictor() {
@@ -201,8 +1201,6 @@ void test_cache_bounds_with_evictor() {
     // Check if any items were evicted unnecessarily
     cache_get(items, "ItemB", gotItemSize, 3);
     cache_get(items, "ItemC", gotItemSize, 4);
-    evictPolicy.~FIFO_Evictor();
-    items.~Cache();
 }
 
 void test_unnecessary_eviction()
@@ -222,8 +1220,6 @@ void test_unnecessary_eviction()
     cache_set(items, "Cdefgh", "ItemC", 7);
     cache_space_used(items, 10);
     cache_get(items, "ItemB", gotItemSize, 3);
-    evictPolicy.~FIFO_Evictor();
-    items.~Cache();
 }
 
 void test_eviction(){
@@ -240,7 +1236,6 @@ void test_eviction(){
     assert(evictedKey == "ItemB" && "Evicted key did not match expectation!");
     evictedKey = evictPolicy.evict();
     assert(evictedKey == "ItemA" && "Evicted key did not match expectation!");
-    evictPolicy.~FIFO_Evictor();
 }
 
 void test_evict_all() {
@@ -262,8 +1257,6 @@ void test_evict_all() {
     cache_get_failure(items, "ItemB", gotItemSize);
     cache_get_failure(items, "ItemC", gotItemSize);
     cache_get(items, "ItemD", gotItemSize, 10);
-    evictPolicy.~FIFO_Evictor();
-    items.~Cache();
 }
 
 void test_size_zero_does_not_evict() {
@@ -284,8 +1277,6 @@ void test_size_zero_does_not_evict() {
     cache_get(items, "ItemA", gotItemSize, 4); // Our code fails at this line
     cache_get(items, "ItemB", gotItemSize, 3);
     cache_get(items, "ItemC", gotItemSize, 3);
-    evictPolicy.~FIFO_Evictor();
-    items.~Cache();
 }
 */
 int main()
@@ -297,6 +1288,34 @@ int main()
     test_cache_bounds();
     test_overflow_no_evictor();
     test_get_non_existant_item();
+    test_memory_used();
+    test_hash_index();
+    test_timing_wheel();
+    test_key_filter();
+    test_slab_allocator();
+    test_slab_budget();
+    test_stats();
+    test_get_shared();
+    test_get_handle();
+    test_binary_values();
+    test_basic_cache();
+    test_clock_evictors();
+    test_slru_cache();
+    test_fifo_caches();
+    test_lfu_cache();
+    test_gdsf_cache();
+    test_evictor_notifications();
+    test_sampled_lru_cache();
+    test_reader_drains();
+    test_tinylfu_cache();
+    test_evictor_stats();
+    test_large_sizes();
+    test_count_overhead();
+    test_sharded_cache();
+    test_background_eviction();
+    test_ttl();
+    test_sharded_reset();
+    test_negative_lookups();
     //test_basic_evictor();
     //test_cache_bounds_with_evictor();
     //test_unnecessary_eviction();
@@ -1,4 +1,25 @@
-/*
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "arc_evictor.hh"
+#include "clock_evictor.hh"
+#include "clock_pro_evictor.hh"
+#include "fifo_evictor.hh"
+#include "gdsf_evictor.hh"
+#include "lfu_evictor.hh"
+#include "lru_evictor.hh"
+#include "s3fifo_evictor.hh"
+#include "sampled_lru_evictor.hh"
+#include "slru_evictor.hh"
+#include "tinylfu_evictor.hh"
+
 void test_eviction(){
     std::cout << "\nDirectly testing evictor...\n";
     LRU_Evictor evictPolicy;
@@ -8,16 +29,714 @@ void test_eviction(){
     evictPolicy.touch_key("ItemA");
     evictPolicy.touch_key("ItemC");
     key_type evictedKey = evictPolicy.evict();
-    assert(evictedKey == "ItemA" && "Evicted key did not match expectation!");
-    evictedKey = evictPolicy.evict();
     assert(evictedKey == "ItemB" && "Evicted key did not match expectation!");
     evictedKey = evictPolicy.evict();
     assert(evictedKey == "ItemA" && "Evicted key did not match expectation!");
-    evictPolicy.~LRU_Evictor();
+    evictedKey = evictPolicy.evict();
+    assert(evictedKey == "ItemC" && "Evicted key did not match expectation!");
+    evictedKey = evictPolicy.evict();
+    assert(evictedKey == "" && "Empty evictor should return an empty key!");
+}
+
+void test_eviction_many() {
+    std::cout << "\nTesting evictor with many keys...\n";
+    LRU_Evictor evictPolicy;
+    // Enough keys to grow the table several times
+    for (int i = 0; i < 10000; ++i) {
+        evictPolicy.touch_key("Key" + std::to_string(i));
+    }
+    // Touch the even keys again, so the odd ones are now oldest
+    for (int i = 0; i < 10000; i += 2) {
+        evictPolicy.touch_key("Key" + std::to_string(i));
+    }
+    assert(evictPolicy.size() == 10000);
+    for (int i = 1; i < 10000; i += 2) {
+        assert(evictPolicy.evict() == "Key" + std::to_string(i));
+    }
+    // Recycled nodes: new keys after evictions, and a key coming back
+    for (int i = 0; i < 100; ++i) {
+        evictPolicy.touch_key("New" + std::to_string(i));
+    }
+    evictPolicy.touch_key("Key1");
+    for (int i = 0; i < 10000; i += 2) {
+        assert(evictPolicy.evict() == "Key" + std::to_string(i));
+    }
+    for (int i = 0; i < 100; ++i) {
+        assert(evictPolicy.evict() == "New" + std::to_string(i));
+    }
+    assert(evictPolicy.evict() == "Key1");
+    assert(evictPolicy.size() == 0 && evictPolicy.evict() == "");
+}
+
+void test_clock() {
+    std::cout << "\nTesting CLOCK evictor...\n";
+    Clock_Evictor evictPolicy;
+    evictPolicy.touch_key("ItemA");
+    evictPolicy.touch_key("ItemB");
+    evictPolicy.touch_key("ItemC");
+    // A hit only sets a bit; ItemA and ItemC get a second chance
+    evictPolicy.touch_key("ItemA");
+    evictPolicy.mark_key("ItemC");
+    evictPolicy.mark_key("NotThere");
+    assert(evictPolicy.evict() == "ItemB");
+    // The hand cleared ItemA's bit on the way, then wrapped around to it
+    evictPolicy.touch_key("ItemD");
+    assert(evictPolicy.evict() == "ItemA");
+    assert(evictPolicy.evict() == "ItemD");
+    assert(evictPolicy.evict() == "ItemC");
+    assert(evictPolicy.size() == 0 && evictPolicy.evict() == "");
+
+    // Forgotten keys leave the circle, so the hand only passes live ones
+    for (int i = 0; i < 1000; ++i) {
+        evictPolicy.touch_key("Key" + std::to_string(i));
+    }
+    for (int i = 0; i < 998; ++i) {
+        evictPolicy.forget_key("Key" + std::to_string(i));
+    }
+    evictPolicy.mark_key("Key998");
+    assert(evictPolicy.peek_victim() == "Key999" && evictPolicy.evict() == "Key999");
+    assert(evictPolicy.evict() == "Key998" && evictPolicy.size() == 0);
+}
+
+// Plays a trace against a simulated cache holding 'capacity' keys, and
+// returns the hit ratio over the accesses from 'warmup' on, not counting
+// keys starting with "Scan". Hits reach the evictor the way the cache
+// passes them on: through mark_key() if it marks, else through touch_key().
+double replay(Evictor& evictPolicy, const std::vector<key_type>& trace,
+              std::size_t capacity, std::size_t warmup)
+{
+    std::unordered_set<key_type> resident;
+    std::size_t hits = 0, accesses = 0;
+    for (std::size_t i = 0; i < trace.size(); ++i) {
+        const key_type& key = trace[i];
+        bool counted = i >= warmup && key.compare(0, 4, "Scan") != 0;
+        accesses += counted;
+        if (resident.count(key)) {
+            if (evictPolicy.concurrent_marks()) {
+                evictPolicy.mark_key(key);
+            }
+            else {
+                evictPolicy.touch_key(key);
+            }
+            hits += counted;
+            continue;
+        }
+        if (resident.size() == capacity) {
+            resident.erase(evictPolicy.evict());
+        }
+        resident.insert(key);
+        evictPolicy.insert_key(key, 1, 1.0);
+        assert(resident.size() <= capacity);
+    }
+    return double(hits) / accesses;
+}
+
+// 20 rounds of 50 hot keys used twice each, then a scan of 200 keys used once
+template <class Evictor_Type>
+double hot_hit_ratio(std::size_t capacity)
+{
+    std::vector<key_type> trace;
+    int scanned = 0;
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            trace.push_back("Hot" + std::to_string(i % 50));
+        }
+        for (int i = 0; i < 200; ++i) {
+            trace.push_back("Scan" + std::to_string(scanned++));
+        }
+    }
+    Evictor_Type evictPolicy;
+    return replay(evictPolicy, trace, capacity, 600);
+}
+
+// Zipf-distributed reads over 'keys' keys, with a scan of 'scan' new keys
+// after every 'period' reads
+std::vector<key_type> zipf_scan_trace(std::size_t length, std::size_t keys,
+                                      std::size_t period, std::size_t scan)
+{
+    std::vector<double> weights;
+    for (std::size_t i = 1; i <= keys; ++i) {
+        weights.push_back(1.0 / i);
+    }
+    std::mt19937_64 rng(389);
+    std::discrete_distribution<std::size_t> zipf(weights.begin(), weights.end());
+    std::vector<key_type> trace;
+    std::size_t scanned = 0;
+    for (std::size_t i = 1; i <= length; ++i) {
+        trace.push_back("Key" + std::to_string(zipf(rng)));
+        if (i % period == 0) {
+            for (std::size_t j = 0; j < scan; ++j) {
+                trace.push_back("Scan" + std::to_string(scanned++));
+            }
+        }
+    }
+    return trace;
+}
+
+void test_scan_resistance() {
+    std::cout << "\nTesting CLOCK-Pro scan resistance...\n";
+    // Every scan is longer than the cache, so LRU and CLOCK lose the hot keys
+    // each round and only hit on their second use. CLOCK-Pro keeps them.
+    assert(hot_hit_ratio<LRU_Evictor>(100) == 0.5);
+    assert(hot_hit_ratio<Clock_Evictor>(100) == 0.5);
+    assert(hot_hit_ratio<Clock_Pro_Evictor>(100) == 1.0);
+
+    // Test entries are bounded by the resident keys, and evicting
+    // everything leaves the evictor empty
+    Clock_Pro_Evictor evictPolicy;
+    for (int i = 0; i < 1000; ++i) {
+        if (i >= 100) {
+            evictPolicy.evict();
+        }
+        evictPolicy.touch_key("Key" + std::to_string(i));
+    }
+    assert(evictPolicy.size() == 100 && evictPolicy.test() <= 100);
+    // A key evicted recently comes back hot
+    evictPolicy.touch_key("Key899");
+    assert(evictPolicy.hot() == 1);
+    while (evictPolicy.evict() != "") {}
+    assert(evictPolicy.size() == 0);
+}
+
+void test_slru() {
+    std::cout << "\nTesting SLRU evictor...\n";
+    SLRU_Evictor evictPolicy(0.5);
+    evictPolicy.touch_key("ItemA");
+    evictPolicy.touch_key("ItemB");
+    evictPolicy.touch_key("ItemC");
+    evictPolicy.touch_key("ItemD");
+    // Second touches protect ItemA and ItemB; with half the keys allowed
+    // protection, touching ItemC too demotes ItemA back to probation
+    evictPolicy.touch_key("ItemA");
+    evictPolicy.touch_key("ItemB");
+    assert(evictPolicy.protected_size() == 2);
+    evictPolicy.touch_key("ItemC");
+    assert(evictPolicy.protected_size() == 2);
+    // Probation, least recent first: ItemD, then the demoted ItemA
+    assert(evictPolicy.evict() == "ItemD");
+    assert(evictPolicy.evict() == "ItemA");
+    // Probation is empty, so the protected segment gives up its oldest
+    assert(evictPolicy.evict() == "ItemB");
+    assert(evictPolicy.evict() == "ItemC");
+    assert(evictPolicy.size() == 0 && evictPolicy.evict() == "");
+
+    // Scans of 500 keys every 1000 Zipf reads, through a cache of 200 keys
+    std::vector<key_type> trace = zipf_scan_trace(100000, 5000, 1000, 500);
+    LRU_Evictor lru;
+    SLRU_Evictor slru;
+    double lru_ratio = replay(lru, trace, 200, 10000);
+    double slru_ratio = replay(slru, trace, 200, 10000);
+    std::cout << "LRU hit ratio: " << lru_ratio << " | SLRU hit ratio: " << slru_ratio << "\n";
+    assert(slru_ratio > lru_ratio + 0.1);
+    assert(hot_hit_ratio<SLRU_Evictor>(100) == 1.0);
+}
+
+void test_arc() {
+    std::cout << "\nTesting ARC evictor...\n";
+    ARC_Evictor evictPolicy;
+    evictPolicy.touch_key("ItemA");
+    evictPolicy.touch_key("ItemB");
+    evictPolicy.touch_key("ItemC");
+    evictPolicy.touch_key("ItemA");
+    // Target starts at 0, so the once-seen keys go first, oldest first
+    assert(evictPolicy.evict() == "ItemB");
+    assert(evictPolicy.stats()["arc_b1"] == 1);
+    // ItemB's ghost says it went too early: T1's target grows, and ItemB
+    // comes back as a frequent key
+    evictPolicy.touch_key("ItemB");
+    assert(evictPolicy.target() > 0);
+    assert(evictPolicy.stats()["arc_b1_hits"] == 1 && evictPolicy.stats()["arc_t2"] == 2);
+    // T1 (ItemC) is at its target of 1 now, so T2 gives up its oldest
+    assert(evictPolicy.evict() == "ItemA");
+    assert(evictPolicy.evict() == "ItemB");
+    assert(evictPolicy.evict() == "ItemC");
+    assert(evictPolicy.size() == 0 && evictPolicy.evict() == "");
+
+    // Popularity shift: first new keys reused at a short distance next to a
+    // small hot set, which pulls the target up; then Zipf reads with scans,
+    // where frequency pays and the target drops back.
+    std::vector<key_type> trace;
+    for (int i = 0; i < 5000; ++i) {
+        trace.push_back("New" + std::to_string(i));
+        if (i >= 60) {
+            trace.push_back("New" + std::to_string(i - 60));
+        }
+        trace.push_back("Hot" + std::to_string(i % 50));
+    }
+    ARC_Evictor arc;
+    LRU_Evictor lru;
+    double arc_ratio = replay(arc, trace, 100, 1000);
+    double lru_ratio = replay(lru, trace, 100, 1000);
+    std::cout << "Recency phase: LRU hit ratio: " << lru_ratio << " | ARC hit ratio: " << arc_ratio
+              << " | target: " << arc.target() << "\n";
+    assert(arc_ratio > lru_ratio && arc.target() > 20);
+    std::vector<key_type> zipf = zipf_scan_trace(50000, 5000, 1000, 500);
+    trace.insert(trace.end(), zipf.begin(), zipf.end());
+    ARC_Evictor shifted;
+    replay(shifted, trace, 100, 0);
+    assert(shifted.target() < 5);
+
+    std::vector<key_type> scans = zipf_scan_trace(100000, 5000, 1000, 500);
+    ARC_Evictor arc_scans;
+    LRU_Evictor lru_scans;
+    arc_ratio = replay(arc_scans, scans, 200, 10000);
+    lru_ratio = replay(lru_scans, scans, 200, 10000);
+    std::cout << "Zipf with scans: LRU hit ratio: " << lru_ratio << " | ARC hit ratio: " << arc_ratio << "\n";
+    assert(arc_ratio > lru_ratio + 0.1);
+}
+
+void test_fifo() {
+    std::cout << "\nTesting FIFO evictor...\n";
+    FIFO_Evictor evictPolicy;
+    evictPolicy.touch_key("ItemA");
+    evictPolicy.touch_key("ItemB");
+    evictPolicy.touch_key("ItemA");
+    evictPolicy.touch_key("ItemC");
+    // Touching ItemA again neither moves it nor queues it twice
+    assert(evictPolicy.size() == 3);
+    assert(evictPolicy.evict() == "ItemA");
+    assert(evictPolicy.evict() == "ItemB");
+    assert(evictPolicy.evict() == "ItemC");
+    assert(evictPolicy.evict() == "");
+
+    // However often keys are touched, the queue stays as long as the key set
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 1000; ++i) {
+            evictPolicy.touch_key("Key" + std::to_string(i));
+        }
+    }
+    assert(evictPolicy.size() == 1000);
+    for (int i = 0; i < 1000; ++i) {
+        assert(evictPolicy.evict() == "Key" + std::to_string(i));
+    }
+    assert(evictPolicy.size() == 0 && evictPolicy.evict() == "");
+}
+
+void test_s3fifo() {
+    std::cout << "\nTesting S3-FIFO evictor...\n";
+    S3FIFO_Evictor evictPolicy(0.5);
+    evictPolicy.touch_key("ItemA");
+    evictPolicy.touch_key("ItemB");
+    evictPolicy.touch_key("ItemC");
+    evictPolicy.touch_key("ItemD");
+    evictPolicy.mark_key("ItemA");
+    evictPolicy.mark_key("NotThere");
+    // ItemA was hit in S, so it moves to M instead of leaving
+    assert(evictPolicy.evict() == "ItemB");
+    assert(evictPolicy.small_size() == 2);
+    auto stats = evictPolicy.stats();
+    assert(stats["s3fifo_main"] == 1 && stats["s3fifo_ghost"] == 1);
+    // ItemB's ghost sends it straight to M when it comes back
+    evictPolicy.touch_key("ItemB");
+    assert(evictPolicy.small_size() == 2 && evictPolicy.stats()["s3fifo_ghost_hits"] == 1);
+    // S (ItemC, ItemD) holds half the keys, so it's evicted from first
+    assert(evictPolicy.evict() == "ItemC");
+    // Then M's ItemA, which leaves S (ItemD) with half the keys again
+    assert(evictPolicy.evict() == "ItemA");
+    assert(evictPolicy.evict() == "ItemD");
+    assert(evictPolicy.evict() == "ItemB");
+    assert(evictPolicy.size() == 0 && evictPolicy.evict() == "");
+
+    // Ghosts are bounded by the share of keys M may hold
+    for (int i = 0; i < 1000; ++i) {
+        if (i >= 100) {
+            evictPolicy.evict();
+        }
+        evictPolicy.touch_key("Key" + std::to_string(i));
+    }
+    assert(evictPolicy.size() == 100 && evictPolicy.stats()["s3fifo_ghost"] <= 50);
+
+    std::vector<key_type> trace = zipf_scan_trace(100000, 5000, 1000, 500);
+    LRU_Evictor lru;
+    FIFO_Evictor fifo;
+    S3FIFO_Evictor s3fifo;
+    double lru_ratio = replay(lru, trace, 200, 10000);
+    double fifo_ratio = replay(fifo, trace, 200, 10000);
+    double s3fifo_ratio = replay(s3fifo, trace, 200, 10000);
+    std::cout << "FIFO hit ratio: " << fifo_ratio << " | LRU hit ratio: " << lru_ratio
+              << " | S3-FIFO hit ratio: " << s3fifo_ratio << "\n";
+    assert(s3fifo_ratio > lru_ratio + 0.1);
+    assert(hot_hit_ratio<S3FIFO_Evictor>(100) == 1.0);
+}
+
+// Reads over 'keys' keys picked the way the workload generator's
+// select_key_get() picks them: exponentially distributed, lambda 6
+std::vector<key_type> exponential_trace(std::size_t length, std::size_t keys)
+{
+    std::mt19937_64 rng(389);
+    std::exponential_distribution<double> distribution(6);
+    std::vector<key_type> trace;
+    for (std::size_t i = 0; i < length; ++i) {
+        double fraction = std::min(distribution(rng) / 2, 1.);
+        std::size_t index = std::min(std::size_t(fraction * keys), keys - 1);
+        trace.push_back("Key" + std::to_string(index));
+    }
+    return trace;
+}
+
+void test_lfu() {
+    std::cout << "\nTesting LFU evictor...\n";
+    LFU_Evictor evictPolicy;
+    evictPolicy.touch_key("ItemA");
+    evictPolicy.touch_key("ItemB");
+    evictPolicy.touch_key("ItemC");
+    evictPolicy.touch_key("ItemA");
+    evictPolicy.touch_key("ItemA");
+    evictPolicy.touch_key("ItemC");
+    assert(evictPolicy.count("ItemA") == 3 && evictPolicy.count("ItemC") == 2);
+    assert(evictPolicy.stats()["lfu_buckets"] == 3);
+    // Least used first; ItemD ties with nobody once ItemB is gone
+    assert(evictPolicy.evict() == "ItemB");
+    evictPolicy.touch_key("ItemD");
+    evictPolicy.touch_key("ItemE");
+    assert(evictPolicy.evict() == "ItemD");
+    assert(evictPolicy.evict() == "ItemE");
+    assert(evictPolicy.evict() == "ItemC");
+    assert(evictPolicy.evict() == "ItemA");
+    assert(evictPolicy.size() == 0 && evictPolicy.evict() == "");
+    assert(evictPolicy.stats()["lfu_buckets"] == 0);
+
+    // Aging: every 4 touches per key, counts halve. The 4th touch of the
+    // only key halves 4 to 2, so 7 touches leave it at 5.
+    LFU_Evictor aging(4);
+    for (int i = 0; i < 7; ++i) {
+        aging.touch_key("Old");
+    }
+    aging.touch_key("New");
+    assert(aging.stats()["lfu_agings"] == 1 && aging.count("Old") == 5 && aging.count("New") == 1);
+    // Once a hot key goes quiet, halving wears its count down and newer
+    // keys overtake it
+    for (int round = 0; round < 10; ++round) {
+        aging.touch_key("New");
+        aging.touch_key("Other");
+    }
+    assert(aging.count("New") > aging.count("Old"));
+    assert(aging.evict() == "Old");
+
+    // Hot keys that stay hot, as in the workload generator's gets: LRU
+    // gives up mid-popularity keys to one-off reads of the long tail
+    std::vector<key_type> trace = exponential_trace(200000, 5000);
+    LRU_Evictor lru;
+    LFU_Evictor lfu;
+    double lru_ratio = replay(lru, trace, 200, 20000);
+    double lfu_ratio = replay(lfu, trace, 200, 20000);
+    std::cout << "LRU hit ratio: " << lru_ratio << " | LFU hit ratio: " << lfu_ratio
+              << " | LFU bytes per key: " << lfu.stats()["lfu_bytes_per_key"] << "\n";
+    assert(lfu_ratio > lru_ratio + 0.05);
+    assert(lfu.stats()["lfu_bytes_per_key"] < 200);
+}
+
+// Like replay(), for a cache holding 'capacity' bytes, where each key has
+// the size 'sizes' gives it. Returns the share of accesses that hit.
+double replay_sized(Evictor& evictPolicy, const std::vector<key_type>& trace,
+                    const std::unordered_map<key_type, uint64_t>& sizes,
+                    uint64_t capacity, std::size_t warmup)
+{
+    std::unordered_map<key_type, uint64_t> resident;
+    uint64_t used = 0;
+    std::size_t hits = 0;
+    for (std::size_t i = 0; i < trace.size(); ++i) {
+        const key_type& key = trace[i];
+        uint64_t size = sizes.at(key);
+        if (resident.count(key)) {
+            evictPolicy.touch_key_sized(key, size, 1);
+            hits += i >= warmup;
+            continue;
+        }
+        while (used + size > capacity) {
+            auto victim = resident.find(evictPolicy.evict());
+            assert(victim != resident.end());
+            used -= victim->second;
+            resident.erase(victim);
+        }
+        resident.emplace(key, size);
+        used += size;
+        evictPolicy.insert_key(key, size, 1);
+    }
+    return double(hits) / (trace.size() - warmup);
+}
+
+void test_gdsf() {
+    std::cout << "\nTesting GDSF evictor...\n";
+    GDSF_Evictor evictPolicy;
+    evictPolicy.touch_key_sized("Small", 2, 1);
+    evictPolicy.touch_key_sized("Big", 115, 1);
+    evictPolicy.touch_key_sized("Costly", 115, 100);
+    evictPolicy.touch_key("Small");
+    assert(evictPolicy.priority("Small") == 1.0);
+    // The big key goes first, unless a miss on it is costly enough
+    assert(evictPolicy.evict() == "Big");
+    assert(evictPolicy.stats()["gdsf_inflation"] == 1.0 / 115);
+    // New keys start from the inflated value, so the old priorities age
+    evictPolicy.touch_key_sized("New", 2, 1);
+    assert(evictPolicy.priority("New") == 1.0 / 115 + 0.5);
+    assert(evictPolicy.evict() == "New");
+    assert(evictPolicy.evict() == "Costly");
+    assert(evictPolicy.evict() == "Small");
+    assert(evictPolicy.size() == 0 && evictPolicy.evict() == "");
+
+    // Policies that don't look at sizes see the same touches as before
+    LRU_Evictor lru;
+    lru.touch_key_sized("ItemA", 2, 1);
+    lru.touch_key_sized("ItemB", 115, 1);
+    lru.touch_key_sized("ItemA", 2, 1);
+    assert(lru.evict() == "ItemB" && lru.evict() == "ItemA");
+
+    // Zipf reads where one key in ten is 50 times bigger than the rest,
+    // through a cache of 2000 bytes
+    std::vector<key_type> trace = zipf_scan_trace(100000, 5000, 100000, 0);
+    std::unordered_map<key_type, uint64_t> sizes;
+    std::mt19937_64 rng(389);
+    for (const auto& key : trace) {
+        if (!sizes.count(key)) {
+            sizes[key] = rng() % 10 == 0 ? 100 : 2;
+        }
+    }
+    LRU_Evictor lru_sized;
+    GDSF_Evictor gdsf;
+    double lru_ratio = replay_sized(lru_sized, trace, sizes, 2000, 10000);
+    double gdsf_ratio = replay_sized(gdsf, trace, sizes, 2000, 10000);
+    std::cout << "LRU hit ratio: " << lru_ratio << " | GDSF hit ratio: " << gdsf_ratio << "\n";
+    assert(gdsf_ratio > lru_ratio + 0.1);
+}
+
+// Forgotten keys never come back out of evict(), and peek_victim() names
+// the key evict() takes next, whatever the policy
+template <class Evictor_Type, class... Args>
+void check_forget(Args&&... args)
+{
+    Evictor_Type evictPolicy(std::forward<Args>(args)...);
+    for (int i = 0; i < 100; ++i) {
+        evictPolicy.insert_key("Key" + std::to_string(i), 1, 1.0);
+    }
+    // Peeking evicts nothing
+    assert(evictPolicy.peek_victim() != "");
+    assert(evictPolicy.size() == 100);
+    for (int i = 0; i < 100; i += 2) {
+        evictPolicy.touch_key("Key" + std::to_string(i));
+    }
+    for (int i = 0; i < 100; i += 3) {
+        evictPolicy.forget_key("Key" + std::to_string(i));
+    }
+    assert(evictPolicy.size() == 66);
+    evictPolicy.forget_key("NotThere");
+    std::unordered_set<key_type> evicted;
+    for (int i = 0; ; ++i) {
+        key_type peeked = i % 2 ? evictPolicy.peek_victim() : "";
+        key_type key = evictPolicy.evict();
+        if (key == "") {
+            break;
+        }
+        assert(i % 2 == 0 || key == peeked);
+        assert(evicted.insert(key).second);
+    }
+    assert(evicted.size() == 66 && !evicted.count("Key0") && !evicted.count("Key99"));
+    assert(evictPolicy.peek_victim() == "");
+
+    // After clear() the evictor starts over
+    evictPolicy.insert_key("ItemA", 1, 1.0);
+    evictPolicy.clear();
+    assert(evictPolicy.size() == 0 && evictPolicy.evict() == "");
+    evictPolicy.insert_key("ItemB", 1, 1.0);
+    assert(evictPolicy.peek_victim() == "ItemB" && evictPolicy.evict() == "ItemB");
+}
+
+void test_forget_and_batches() {
+    std::cout << "\nTesting forget_key(), clear() and evict_bytes()...\n";
+    check_forget<LRU_Evictor>();
+    check_forget<FIFO_Evictor>();
+    check_forget<SLRU_Evictor>();
+    check_forget<ARC_Evictor>();
+    check_forget<Clock_Evictor>();
+    check_forget<Clock_Pro_Evictor>();
+    check_forget<S3FIFO_Evictor>();
+    check_forget<LFU_Evictor>();
+    check_forget<GDSF_Evictor>();
+    check_forget<Sampled_LRU_Evictor>();
+    check_forget<TinyLFU_Evictor>(std::unique_ptr<Evictor>(new LRU_Evictor()));
+    check_forget<TinyLFU_Evictor>(std::unique_ptr<Evictor>(new ARC_Evictor()));
+    check_forget<TinyLFU_Evictor>(std::unique_ptr<Evictor>(new Clock_Pro_Evictor()));
+
+    // One call hands out victims until their sizes cover the request;
+    // sizes of 0 (keys the caller no longer has) don't count
+    LRU_Evictor evictPolicy;
+    for (int i = 0; i < 10; ++i) {
+        evictPolicy.touch_key("Key" + std::to_string(i));
+    }
+    auto size_of = [](const key_type& key) -> uint64_t {
+        return key.empty() || key == "Key1" ? 0 : 3;
+    };
+    std::vector<key_type> victims;
+    assert(evictPolicy.evict_bytes(7, size_of, victims) == 9);
+    assert((victims == std::vector<key_type>{ "Key0", "Key1", "Key2", "Key3" }));
+    // Running dry stops short
+    victims.clear();
+    Evictor& base = evictPolicy;
+    assert(base.evict_bytes(100, size_of, victims) == 18 && victims.size() == 6);
+    assert(evictPolicy.size() == 0);
+}
+
+void test_sampled_lru() {
+    std::cout << "\nTesting sampled LRU evictor...\n";
+    // With many samples per eviction it is LRU, hits through mark_key()
+    // included
+    Sampled_LRU_Evictor evictPolicy(64);
+    for (int i = 0; i < 10; ++i) {
+        evictPolicy.touch_key("Key" + std::to_string(i));
+    }
+    evictPolicy.mark_key("Key0");
+    evictPolicy.touch_key("Key1");
+    evictPolicy.mark_key("NotThere");
+    for (int i = 2; i < 9; ++i) {
+        assert(evictPolicy.evict() == "Key" + std::to_string(i));
+    }
+    // The clock only ticks on writes, so Key0's hit is stamped with the
+    // time of Key9's set, and the two tie
+    std::unordered_set<key_type> tied{ evictPolicy.evict(), evictPolicy.evict() };
+    assert(tied.count("Key0") && tied.count("Key9"));
+    assert(evictPolicy.evict() == "Key1");
+    assert(evictPolicy.size() == 0 && evictPolicy.evict() == "");
+
+    // With Redis's 5 samples it stays close to LRU
+    std::vector<key_type> trace = zipf_scan_trace(100000, 5000, 100000, 0);
+    LRU_Evictor lru;
+    Sampled_LRU_Evictor sampled;
+    double lru_ratio = replay(lru, trace, 200, 10000);
+    double sampled_ratio = replay(sampled, trace, 200, 10000);
+    std::cout << "LRU hit ratio: " << lru_ratio << " | sampled LRU hit ratio: " << sampled_ratio << "\n";
+    assert(std::abs(sampled_ratio - lru_ratio) < 0.03);
+}
+
+// Ten keys seen once each into a TinyLFU over 'main': the window's oldest
+// key loses its duel, and the main victim it lost to stays as it was
+void check_tinylfu_reject(TinyLFU_Evictor& tinylfu, Evictor& main)
+{
+    for (int i = 0; i < 10; ++i) {
+        tinylfu.insert_key("Key" + std::to_string(i), 10, 1.0);
+    }
+    assert(tinylfu.peek_victim() == "Key8");
+    key_type victim = main.peek_victim();
+    assert(victim != "" && tinylfu.evict() == "Key8");
+    assert(main.peek_victim() == victim);
+    assert(tinylfu.stats()["tinylfu_rejected"] == 1 && tinylfu.size() == 9);
+}
+
+// On 'trace', TinyLFU in front of Main does at least as well as Main alone
+template <class Main>
+void check_tinylfu_over(const std::vector<key_type>& trace)
+{
+    Main alone;
+    TinyLFU_Evictor tinylfu(std::unique_ptr<Evictor>(new Main()));
+    double alone_ratio = replay(alone, trace, 200, 10000);
+    double tinylfu_ratio = replay(tinylfu, trace, 200, 10000);
+    assert(tinylfu_ratio >= alone_ratio);
+}
+
+void test_tinylfu() {
+    std::cout << "\nTesting TinyLFU admission...\n";
+    TinyLFU_Evictor evictPolicy(std::unique_ptr<Evictor>(new LRU_Evictor()));
+    for (int i = 0; i < 10; ++i) {
+        evictPolicy.insert_key("Key" + std::to_string(i), 1, 1.0);
+    }
+    evictPolicy.touch_key("Key9");
+    evictPolicy.touch_key("Key9");
+    // The window keeps one key; the rest went to the LRU as the cache filled.
+    // Key8 has been seen once, like the LRU's victim Key0, so it loses.
+    assert(evictPolicy.evict() == "Key8");
+    assert(evictPolicy.window_size() == 1 && evictPolicy.stats()["tinylfu_rejected"] == 1);
+    // Forgetting a key it no longer holds changes nothing
+    evictPolicy.forget_key("Key8");
+    assert(evictPolicy.size() == 9 && evictPolicy.stats()["tinylfu_main"] == 8);
+    // Key9 was seen three times: it gets in, and Key0 goes (winning left it
+    // where it was, at the LRU's old end)
+    evictPolicy.insert_key("New", 1, 1.0);
+    assert(evictPolicy.frequency("Key9") == 3);
+    assert(evictPolicy.peek_victim() == "Key0" && evictPolicy.peek_victim() == "Key0");
+    assert(evictPolicy.window_size() == 2);
+    assert(evictPolicy.evict() == "Key0");
+    assert(evictPolicy.stats()["tinylfu_admitted"] == 1);
+    assert(evictPolicy.size() == 9);
+    while (evictPolicy.evict() != "") {}
+    assert(evictPolicy.size() == 0);
+
+    // Counts survive the sketch growing with the keys
+    evictPolicy.insert_key("Hot", 1, 1.0);
+    for (int i = 0; i < 3; ++i) {
+        evictPolicy.touch_key("Hot");
+    }
+    for (int i = 0; i < 100; ++i) {
+        evictPolicy.insert_key("Cold" + std::to_string(i), 1, 1.0);
+    }
+    assert(evictPolicy.frequency("Hot") >= 4);
+
+    // Readers' marks reach a CLOCK main policy, but hits are still replayed
+    Clock_Evictor* clock = new Clock_Evictor();
+    TinyLFU_Evictor over_clock(std::unique_ptr<Evictor>{ clock });
+    for (int i = 0; i < 10; ++i) {
+        over_clock.insert_key("Key" + std::to_string(i), 1, 1.0);
+    }
+    assert(over_clock.concurrent_marks() && !over_clock.marks_replace_touches());
+    over_clock.mark_key("Key0");
+    assert(clock->peek_victim() == "Key1");
+
+    // Policies with history don't take the victim for a key coming back: no
+    // ghost hits for ARC or S3-FIFO, no promotion for CLOCK-Pro, and GDSF
+    // keeps its size
+    ARC_Evictor* arc = new ARC_Evictor();
+    TinyLFU_Evictor over_arc(std::unique_ptr<Evictor>{ arc });
+    check_tinylfu_reject(over_arc, *arc);
+    assert(arc->stats()["arc_b1_hits"] == 0 && arc->stats()["arc_t2"] == 0);
+    S3FIFO_Evictor* s3fifo = new S3FIFO_Evictor();
+    TinyLFU_Evictor over_s3fifo(std::unique_ptr<Evictor>{ s3fifo });
+    check_tinylfu_reject(over_s3fifo, *s3fifo);
+    assert(s3fifo->stats()["s3fifo_ghost_hits"] == 0 && s3fifo->stats()["s3fifo_main"] == 0);
+    Clock_Pro_Evictor* clock_pro = new Clock_Pro_Evictor();
+    TinyLFU_Evictor over_clock_pro(std::unique_ptr<Evictor>{ clock_pro });
+    check_tinylfu_reject(over_clock_pro, *clock_pro);
+    assert(clock_pro->hot() == 0 && clock_pro->test() == 0);
+    GDSF_Evictor* gdsf = new GDSF_Evictor();
+    TinyLFU_Evictor over_gdsf(std::unique_ptr<Evictor>{ gdsf });
+    check_tinylfu_reject(over_gdsf, *gdsf);
+    assert(gdsf->priority(gdsf->peek_victim()) == 0.1);
+
+    // Zipf reads with scans of new keys through a cache of 200 keys: the
+    // scans' one-off keys no longer push out the popular ones
+    std::vector<key_type> trace = zipf_scan_trace(100000, 5000, 1000, 500);
+    LRU_Evictor lru;
+    TinyLFU_Evictor tinylfu(std::unique_ptr<Evictor>(new LRU_Evictor()));
+    double lru_ratio = replay(lru, trace, 200, 10000);
+    double tinylfu_ratio = replay(tinylfu, trace, 200, 10000);
+    std::cout << "LRU hit ratio: " << lru_ratio << " | TinyLFU+LRU hit ratio: " << tinylfu_ratio
+              << " | sketch bytes: " << tinylfu.stats()["tinylfu_sketch_bytes"] << "\n";
+    assert(tinylfu_ratio > lru_ratio + 0.05);
+    check_tinylfu_over<ARC_Evictor>(trace);
+    check_tinylfu_over<S3FIFO_Evictor>(trace);
+    check_tinylfu_over<Clock_Pro_Evictor>(trace);
+    check_tinylfu_over<GDSF_Evictor>(trace);
+    // Long tail without scans
+    std::vector<key_type> tail = zipf_scan_trace(100000, 20000, 100000, 0);
+    LRU_Evictor lru_tail;
+    TinyLFU_Evictor tinylfu_tail(std::unique_ptr<Evictor>(new LRU_Evictor()));
+    lru_ratio = replay(lru_tail, tail, 200, 10000);
+    tinylfu_ratio = replay(tinylfu_tail, tail, 200, 10000);
+    std::cout << "Long tail: LRU hit ratio: " << lru_ratio << " | TinyLFU+LRU hit ratio: " << tinylfu_ratio << "\n";
+    assert(tinylfu_ratio > lru_ratio + 0.03);
 }
-*/
+
 int main()
 {
-    //test_eviction();
+    test_eviction();
+    test_eviction_many();
+    test_clock();
+    test_scan_resistance();
+    test_slru();
+    test_arc();
+    test_fifo();
+    test_s3fifo();
+    test_lfu();
+    test_gdsf();
+    test_forget_and_batches();
+    test_sampled_lru();
+    test_tinylfu();
     return 0;
 }
@@ -453,17 +453,16 @@ baseline_latencies(int nreq, double& total_time, std::map<double, int>& times_ma
     duration_vector_mutex.lock();
     request_durations.insert(request_durations.end(), nreq_timings.begin(), nreq_timings.end());
     duration_vector_mutex.unlock();
-
-	items.~Cache();
 }
 
 //------------------------------------------------------------------MAIN--------------------------------------------------------------//
 
 int main(int argc, char** argv)
 {
-    Cache disposable_cache(HOST, PORT); //Used exclusively for warmup
-    cache_warmup(disposable_cache);
-    disposable_cache.~Cache();
+    {
+        Cache disposable_cache(HOST, PORT); //Used exclusively for warmup
+        cache_warmup(disposable_cache);
+    }
     /*
         Main takes a single parameter, which determines what kind of test the program runs
 
@@ -0,0 +1,188 @@
+/*
+ * A hierarchical timing wheel, for expiring cache entries in O(1) each.
+ *
+ * Time is counted in ticks. Level 0 has one slot per tick for the next 64
+ * ticks, level 1 one slot per 64 ticks for the next 64^2, and so on up to
+ * LEVELS levels. An entry goes into the slot of the coarsest level its
+ * deadline needs; when the wheel reaches that slot the entry drops to a finer
+ * level (a cascade), until the level 0 slot of its deadline expires it. So
+ * scheduling, cancelling and expiring are constant time, and each entry is
+ * moved at most LEVELS - 1 times. Deadlines further out than the wheel
+ * reaches wait in the top level and are placed again each time round.
+ *
+ * The wheel is intrusive: each Node carries a Wheel_Hook, which Hook_Of (a
+ * functor taking Node& and returning its Wheel_Hook<Node>&) finds, so
+ * nothing is allocated per entry. Nodes must not move while scheduled.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+template <class Node>
+struct Wheel_Hook {
+  Node* prev = nullptr;
+  Node* next = nullptr;
+  uint64_t deadline = 0;   // Tick it expires at; 0 while not scheduled
+  uint32_t slot = 0;       // level * SLOTS + slot index, while scheduled
+};
+
+template <class Node, class Hook_Of>
+class Timing_Wheel {
+ public:
+  static constexpr unsigned BITS = 6;
+  static constexpr unsigned SLOTS = 1u << BITS;
+  static constexpr unsigned LEVELS = 5;
+
+  explicit Timing_Wheel(Hook_Of hook_of = Hook_Of()) : hook_of_(hook_of) {}
+
+  Timing_Wheel(const Timing_Wheel&) = delete;
+  Timing_Wheel& operator=(const Timing_Wheel&) = delete;
+
+  // The tick advance() last reached
+  uint64_t now() const { return now_; }
+
+  // Expire node at tick 'deadline' (at least 1). A deadline that has already
+  // passed expires it on the next advance().
+  void schedule(Node& node, uint64_t deadline) {
+    assert(deadline != 0 && "Deadline 0 means unscheduled");
+    Wheel_Hook<Node>& hook = hook_of_(node);
+    assert(hook.deadline == 0 && "Node is already scheduled");
+    hook.deadline = deadline;
+    place(node);
+    ++size_;
+  }
+
+  // Take node off the wheel before it expires
+  void cancel(Node& node) {
+    Wheel_Hook<Node>& hook = hook_of_(node);
+    assert(hook.deadline != 0 && "Node isn't scheduled");
+    unlink(node);
+    hook.deadline = 0;
+    --size_;
+  }
+
+  // Move the wheel on to tick 'now', calling expire(Node&) for each node
+  // whose deadline has come, at most 'budget' of them. Nodes are off the wheel
+  // by the time expire() sees them, and it may destroy them. Returns how many
+  // expired; if that is 'budget', some due nodes may remain for the next call.
+  template <class F>
+  std::size_t advance(uint64_t now, std::size_t budget, F expire) {
+    std::size_t expired = 0;
+    if (size_ == 0) {
+      now_ = std::max(now_, now);
+      return 0;
+    }
+    // The current slot may still hold nodes a smaller budget left behind
+    expired += drain(now_ & (SLOTS - 1), budget, expire);
+    while (now_ < now && expired < budget) {
+      if (level_size_[0] == 0) {
+        // Nothing is due before the next cascade: skip to it
+        uint64_t boundary = (now_ | (SLOTS - 1)) + 1;
+        if (boundary > now) {
+          now_ = now;
+          break;
+        }
+        now_ = boundary;
+      }
+      else {
+        ++now_;
+      }
+      for (unsigned level = LEVELS - 1; level > 0; --level) {
+        if ((now_ & ((uint64_t(1) << (BITS * level)) - 1)) == 0) {
+          cascade(level, (now_ >> (BITS * level)) & (SLOTS - 1));
+        }
+      }
+      expired += drain(now_ & (SLOTS - 1), budget - expired, expire);
+    }
+    return expired;
+  }
+
+  // Nodes scheduled
+  std::size_t size() const { return size_; }
+
+  // Forget every node, leaving their hooks as they are. For when the nodes
+  // themselves are being thrown away.
+  void clear() {
+    for (auto& slot : slots_) {
+      slot = nullptr;
+    }
+    for (auto& count : level_size_) {
+      count = 0;
+    }
+    size_ = 0;
+  }
+
+ private:
+  // Put a node whose hook holds its deadline into the slot that fits it
+  void place(Node& node) {
+    Wheel_Hook<Node>& hook = hook_of_(node);
+    uint64_t deadline = hook.deadline;
+    uint64_t delta = deadline > now_ ? deadline - now_ : 0;
+    if (delta == 0) {
+      deadline = now_;
+    }
+    unsigned level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t(1) << (BITS * (level + 1)))) {
+      ++level;
+    }
+    if (level == LEVELS - 1 && delta >= (uint64_t(1) << (BITS * LEVELS))) {
+      // Beyond the wheel: park it where the top level ends, to be placed again
+      deadline = now_ + (uint64_t(1) << (BITS * LEVELS)) - 1;
+    }
+    uint32_t slot = level * SLOTS + ((deadline >> (BITS * level)) & (SLOTS - 1));
+    hook.slot = slot;
+    hook.prev = nullptr;
+    hook.next = slots_[slot];
+    if (hook.next != nullptr) {
+      hook_of_(*hook.next).prev = &node;
+    }
+    slots_[slot] = &node;
+    ++level_size_[level];
+  }
+
+  void unlink(Node& node) {
+    Wheel_Hook<Node>& hook = hook_of_(node);
+    if (hook.prev == nullptr) slots_[hook.slot] = hook.next;
+    else hook_of_(*hook.prev).next = hook.next;
+    if (hook.next != nullptr) hook_of_(*hook.next).prev = hook.prev;
+    hook.prev = hook.next = nullptr;
+    --level_size_[hook.slot / SLOTS];
+  }
+
+  // Spread a slot of a coarser level over the finer ones
+  void cascade(unsigned level, uint64_t index) {
+    Node* node = slots_[level * SLOTS + index];
+    slots_[level * SLOTS + index] = nullptr;
+    while (node != nullptr) {
+      Node* next = hook_of_(*node).next;
+      --level_size_[level];
+      place(*node);
+      node = next;
+    }
+  }
+
+  // Expire up to 'budget' nodes of level 0's slot 'index'
+  template <class F>
+  std::size_t drain(uint64_t index, std::size_t budget, F& expire) {
+    std::size_t expired = 0;
+    while (expired < budget && slots_[index] != nullptr) {
+      Node& node = *slots_[index];
+      unlink(node);
+      hook_of_(node).deadline = 0;
+      --size_;
+      ++expired;
+      expire(node);
+    }
+    return expired;
+  }
+
+  Hook_Of hook_of_;
+  Node* slots_[LEVELS * SLOTS] = {};
+  std::size_t level_size_[LEVELS] = {};
+  std::size_t size_ = 0;
+  uint64_t now_ = 0;
+};
@@ -0,0 +1,219 @@
+/*
+ * Implementation of the TinyLFU_Evictor declared in tinylfu_evictor.hh.
+ */
+
+#include "tinylfu_evictor.hh"
+#include <algorithm>
+#include <cassert>
+
+TinyLFU_Evictor::TinyLFU_Evictor(std::unique_ptr<Evictor> main, double window_ratio)
+    : main_(std::move(main)), window_ratio_(window_ratio)
+{
+    assert(main_ != nullptr && "TinyLFU needs a main eviction policy");
+    assert(window_ratio >= 0 && window_ratio <= 1 && "Window share must be within [0, 1]");
+}
+
+void
+TinyLFU_Evictor::record(std::size_t hash)
+// Counts an access, growing the sketch along with the keys
+{
+    sketch_.ensure_capacity(size());
+    sketch_.increment(hash);
+}
+
+bool
+TinyLFU_Evictor::touch_window(const key_type& key, std::size_t hash)
+// Moves key to the window's most recent end, if it's in the window
+{
+    uint32_t n = window_.find(key, hash);
+    if (n == NIL) {
+        return false;
+    }
+    if (n != window_lru_.tail) {
+        window_lru_.unlink(window_, n);
+        window_lru_.push_back(window_, n);
+    }
+    return true;
+}
+
+std::size_t
+TinyLFU_Evictor::window_target() const
+{
+    return std::max<std::size_t>(1, window_ratio_ * size());
+}
+
+void
+TinyLFU_Evictor::enter_main(uint32_t n)
+// Moves window record n, already unlinked from the LRU, to the main policy
+{
+    std::size_t hash = window_[n].hash;
+    main_->insert_key(window_[n].key, window_[n].size, window_[n].cost);
+    // Two keys with one 64-bit hash would share a record
+    if (main_keys_.find(hash, hash) == NIL) {
+        main_keys_.insert(hash, hash);
+    }
+    window_.erase(n);
+}
+
+void
+TinyLFU_Evictor::touch_key(const key_type& key)
+{
+    std::size_t hash = window_.hash(key);
+    record(hash);
+    if (!touch_window(key, hash) && main_keys_.find(hash, hash) != NIL) {
+        main_->touch_key(key);
+    }
+}
+
+void
+TinyLFU_Evictor::touch_key_sized(const key_type& key, uint64_t size, double cost)
+{
+    std::size_t hash = window_.hash(key);
+    record(hash);
+    uint32_t n = window_.find(key, hash);
+    if (n == NIL) {
+        if (main_keys_.find(hash, hash) != NIL) {
+            main_->touch_key_sized(key, size, cost);
+        }
+        return;
+    }
+    window_[n].size = size;
+    window_[n].cost = cost;
+    touch_window(key, hash);
+}
+
+void
+TinyLFU_Evictor::insert_key(const key_type& key, uint64_t size, double cost)
+// Every new key starts in the window
+{
+    std::size_t hash = window_.hash(key);
+    record(hash);
+    if (touch_window(key, hash)) {
+        return;
+    }
+    if (main_keys_.find(hash, hash) != NIL) {
+        main_->touch_key_sized(key, size, cost);
+        return;
+    }
+    uint32_t n = window_.insert(key, hash);
+    window_[n].size = size;
+    window_[n].cost = cost;
+    window_lru_.push_back(window_, n);
+    // While the cache fills up, the main space has room for everything the
+    // window can't hold: that goes straight in, and only the last key to
+    // leave the window has to compete for its place once evictions start
+    std::size_t target = window_target();
+    while (window_.size() > target + 1) {
+        enter_main(window_lru_.pop_front(window_));
+    }
+}
+
+TinyLFU_Evictor::Choice
+TinyLFU_Evictor::choose(key_type& victim) const
+// Decides what evict() takes next and sets 'victim' to it, changing nothing
+{
+    bool main_empty = main_->empty();
+    if (!main_empty) {
+        victim = main_->peek_victim();
+        if (window_.size() <= window_target()) {
+            return MAIN;
+        }
+    }
+    if (window_.size() == 0) {
+        return NOTHING;
+    }
+
+    // The window's oldest key tries to get into the main space
+    const Node& candidate = window_[window_lru_.head];
+    if (main_empty) {
+        victim = candidate.key;
+        return WINDOW;
+    }
+    // Ties go to the victim, so a flood of new keys can't churn the main space
+    if (sketch_.estimate(candidate.hash) > sketch_.estimate(window_.hash(victim))) {
+        return ADMIT;
+    }
+    victim = candidate.key;
+    return REJECT;
+}
+
+const key_type
+TinyLFU_Evictor::evict()
+// The main policy's victim is only evicted from it once it has lost, so
+// one that stays keeps its place, size and history there
+{
+    key_type victim;
+    Choice choice = choose(victim);
+    if (choice == NOTHING) {
+        return "";
+    }
+    if (choice == MAIN || choice == ADMIT) {
+        main_->evict();
+        std::size_t hash = window_.hash(victim);
+        uint32_t m = main_keys_.find(hash, hash);
+        if (m != NIL) {
+            main_keys_.erase(m);
+        }
+    }
+    if (choice == MAIN) {
+        return victim;
+    }
+    uint32_t n = window_lru_.pop_front(window_);
+    if (choice == ADMIT) {
+        ++admitted_;
+        enter_main(n);
+        return victim;
+    }
+    if (choice == REJECT) {
+        ++rejected_;
+    }
+    window_.erase(n);
+    return victim;
+}
+
+const key_type
+TinyLFU_Evictor::peek_victim()
+{
+    key_type victim;
+    choose(victim);
+    return victim;
+}
+
+void
+TinyLFU_Evictor::forget_key(const key_type& key)
+{
+    std::size_t hash = window_.hash(key);
+    uint32_t n = window_.find(key, hash);
+    if (n != NIL) {
+        window_lru_.unlink(window_, n);
+        window_.erase(n);
+        return;
+    }
+    uint32_t m = main_keys_.find(hash, hash);
+    if (m != NIL) {
+        main_keys_.erase(m);
+        main_->forget_key(key);
+    }
+}
+
+void
+TinyLFU_Evictor::clear()
+{
+    window_.clear();
+    window_lru_ = Index_List();
+    main_keys_.clear();
+    main_->clear();
+}
+
+std::map<std::string, double>
+TinyLFU_Evictor::stats() const
+{
+    std::map<std::string, double> result = main_->stats();
+    result["tinylfu_window"] = window_.size();
+    result["tinylfu_main"] = main_keys_.size();
+    result["tinylfu_admitted"] = admitted_;
+    result["tinylfu_rejected"] = rejected_;
+    result["tinylfu_sketch_bytes"] = sketch_.memory_bytes();
+    result["tinylfu_sketch_resets"] = sketch_.resets();
+    return result;
+}
@@ -0,0 +1,111 @@
+/*
+ * Declarations for W-TinyLFU admission in front of another eviction policy, according to the pattern in evictor.hh.
+ * Implemented in tinylfu_evictor.cc.
+ *
+ * W-TinyLFU (as in Caffeine) puts new keys in a small LRU window first, 1%
+ * of the keys by default, which any other policy then guards as its main
+ * space. When the window overflows, its least recently used key is the
+ * candidate to enter the main space, and the main policy's next victim is
+ * the key that would have to make room. Whichever of the two a
+ * Frequency_Sketch has seen more often stays; the other is evicted. So a
+ * key seen once can't push out one that keeps coming back, while the
+ * window still lets bursts of new keys get a few hits in.
+ *
+ * The main policy's victim is found with peek_victim() and only evicted
+ * once it has lost, so one that wins stays where it was, and policies that
+ * keep history (ARC's ghosts, CLOCK-Pro's test entries, GDSF's sizes) never
+ * see it leave and come back. While the cache fills up, keys the window
+ * can't hold go straight into the main space as they are inserted, so
+ * peek_victim() itself moves nothing.
+ *
+ * Beyond the window's own records (about 60 bytes per window key), the
+ * sketch costs about five bytes per key, and knowing which keys the main
+ * space holds about 25 more. New keys must come in through insert_key(), as
+ * the cache does, to enter the window; touches for keys it doesn't hold
+ * only count towards their frequency.
+ *
+ * A main policy with concurrent_marks() gets readers' marks passed on, but
+ * the sketch and window still need each hit replayed through touch_key().
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "evictor.hh"
+#include "frequency_sketch.hh"
+#include "key_table.hh"
+
+class TinyLFU_Evictor final : public Evictor {
+private:
+    struct Node {
+        key_type key;
+        std::size_t hash;
+        uint32_t prev;  // Towards the least recently used end
+        uint32_t next;  // Towards the most recently used end
+        uint64_t size;
+        double cost;
+    };
+    // A main key is known by its hash alone, like ARC's ghosts
+    struct Resident {
+        std::size_t key;
+        std::size_t hash;
+    };
+    using Table = Key_Table<Node>;
+    static constexpr uint32_t NIL = Table::NIL;
+
+    std::unique_ptr<Evictor> main_;
+    Table window_;
+    Index_List window_lru_;
+    Key_Table<Resident, std::size_t> main_keys_;    // Keys the main policy holds
+    double window_ratio_;
+    Frequency_Sketch sketch_;
+    uint64_t admitted_ = 0;         // Candidates that beat the main victim
+    uint64_t rejected_ = 0;
+
+    // What evict() does next: nothing, take the main policy's victim, take
+    // the window's oldest key while main is empty, or settle a duel between
+    // the two, admitting that key in the victim's place or rejecting it.
+    enum Choice { NOTHING, MAIN, WINDOW, ADMIT, REJECT };
+
+    void record(std::size_t hash);
+    bool touch_window(const key_type& key, std::size_t hash);
+    std::size_t window_target() const;
+    void enter_main(uint32_t n);
+    Choice choose(key_type& victim) const;
+
+public:
+    // main: the policy for keys that made it past the window.
+    // window_ratio: share of the keys the window holds, between 0 and 1.
+    explicit TinyLFU_Evictor(std::unique_ptr<Evictor> main, double window_ratio = 0.01);
+    TinyLFU_Evictor(const TinyLFU_Evictor&) = delete;
+    TinyLFU_Evictor& operator=(const TinyLFU_Evictor&) = delete;
+
+    void touch_key(const key_type&) override;
+    void touch_key_sized(const key_type&, uint64_t size, double cost) override;
+    void insert_key(const key_type&, uint64_t size, double cost) override;
+    const key_type evict() override;
+    const key_type peek_victim() override;
+    bool empty() const override { return window_.size() == 0 && main_->empty(); }
+    uint64_t evict_bytes(uint64_t bytes, const size_fn& size_of,
+                         std::vector<key_type>& victims) override {
+        return evict_bytes_of(*this, bytes, size_of, victims);
+    }
+    void forget_key(const key_type&) override;
+    void clear() override;
+
+    // Marks go to the main policy, if it takes them; window keys are
+    // unknown to it, so it ignores theirs
+    bool concurrent_marks() const override { return main_->concurrent_marks(); }
+    bool marks_replace_touches() const override { return false; }
+    void mark_key(const key_type& key) const override { main_->mark_key(key); }
+
+    // Window and main sizes, admissions, the sketch's size and resets, and
+    // the main policy's own stats
+    std::map<std::string, double> stats() const override;
+
+    // Number of keys tracked, in the window and the main policy
+    std::size_t size() const { return window_.size() + main_keys_.size(); }
+    std::size_t window_size() const { return window_.size(); }
+    unsigned frequency(const key_type& key) const { return sketch_.estimate(window_.hash(key)); }
+};
@@ -0,0 +1,88 @@
+/*
+ * Striped, bounded ring buffers that let readers record what they touched
+ * without a lock, for a single drainer to replay later, as in Caffeine's
+ * read buffers.
+ *
+ * Each thread offers to one stripe, picked once per thread, so readers on
+ * different threads rarely contend on a counter and never on a cache line.
+ * A stripe holds CAPACITY entries; once it is full, offers fail and the
+ * entry is dropped until someone drains. Only one thread may drain at a
+ * time, but offers may run meanwhile: the drainer takes each slot with an
+ * exchange and stops at one whose reader has claimed it but not filled it
+ * yet, leaving the rest for the next drain.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+template <class T, std::size_t STRIPES = 16, std::size_t CAPACITY = 32>
+class Touch_Buffer {
+  static_assert((STRIPES & (STRIPES - 1)) == 0, "Stripe count must be a power of two");
+
+ public:
+  // Record p. False if the caller's stripe is full, in which case p is not
+  // recorded and the caller should drain or give up on it.
+  bool offer(T* p) {
+    Stripe& stripe = stripes_[stripe_index()];
+    uint64_t writes = stripe.writes.load(std::memory_order_relaxed);
+    do {
+      if (writes - stripe.reads.load(std::memory_order_acquire) >= CAPACITY) {
+        return false;
+      }
+    } while (!stripe.writes.compare_exchange_weak(writes, writes + 1, std::memory_order_relaxed));
+    stripe.slots[writes % CAPACITY].store(p, std::memory_order_release);
+    return true;
+  }
+
+  // Call f(T*) on the recorded entries, in order within each stripe, and
+  // remove them. Returns how many there were.
+  template <class F>
+  std::size_t drain(F f) {
+    std::size_t drained = 0;
+    for (Stripe& stripe : stripes_) {
+      uint64_t reads = stripe.reads.load(std::memory_order_relaxed);
+      uint64_t writes = stripe.writes.load(std::memory_order_acquire);
+      for (; reads < writes; ++reads) {
+        T* p = stripe.slots[reads % CAPACITY].exchange(nullptr, std::memory_order_acquire);
+        if (p == nullptr) {
+          break;      // Claimed, but not filled in yet
+        }
+        f(p);
+        ++drained;
+      }
+      stripe.reads.store(reads, std::memory_order_release);
+    }
+    return drained;
+  }
+
+  // Drop everything recorded. No offer may run meanwhile.
+  void clear() {
+    for (Stripe& stripe : stripes_) {
+      for (auto& slot : stripe.slots) {
+        slot.store(nullptr, std::memory_order_relaxed);
+      }
+      stripe.reads.store(stripe.writes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  // Counters only grow, so a slot is reused only after the drainer has
+  // passed it and reads has moved on.
+  struct alignas(64) Stripe {
+    std::atomic<uint64_t> writes{0};    // Slots claimed by readers
+    std::atomic<uint64_t> reads{0};     // Slots consumed by the drainer
+    std::atomic<T*> slots[CAPACITY] = {};
+  };
+
+  static std::size_t stripe_index() {
+    static std::atomic<std::size_t> next_thread{0};
+    static thread_local const std::size_t index =
+        next_thread.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+    return index;
+  }
+
+  Stripe stripes_[STRIPES];
+};
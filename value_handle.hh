@@ -0,0 +1,65 @@
+/*
+ * A reference to a value stored in a cache, returned by the caches' one
+ * argument get(key). Declared on its own so that Cache and BasicCache (see
+ * "basic_cache.hh") can both hand them out.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// The bytes stay valid, without being copied, for as long as the handle
+// exists, even if the key is overwritten, deleted or evicted meanwhile.
+// Handles may be moved to and released on any thread, but must not
+// outlive the cache they came from. (A ShardedCache's reset() keeps the old
+// contents until their handles are released.)
+class Value_Handle {
+ public:
+  using byte_type = char;
+  using size_type = uint64_t;
+  using release_func = void (*)(const byte_type*);
+
+  Value_Handle() = default;
+  Value_Handle(const byte_type* data, std::size_t length, size_type size, release_func release)
+    : data_(data), length_(length), size_(size), release_(release) {}
+  ~Value_Handle() { reset(); }
+
+  Value_Handle(Value_Handle&& other) noexcept { *this = std::move(other); }
+  Value_Handle& operator=(Value_Handle&& other) noexcept {
+    if (this != &other) {
+      reset();
+      data_ = other.data_;
+      length_ = other.length_;
+      size_ = other.size_;
+      release_ = other.release_;
+      other.data_ = nullptr;
+    }
+    return *this;
+  }
+  Value_Handle(const Value_Handle&) = delete;
+  Value_Handle& operator=(const Value_Handle&) = delete;
+
+  // False for a miss
+  explicit operator bool() const { return data_ != nullptr; }
+  // The stored bytes, and how many there are
+  const byte_type* data() const { return data_; }
+  std::size_t length() const { return length_; }
+  // The size given when the value was set
+  size_type size() const { return size_; }
+
+  // Drop the reference early
+  void reset() {
+    if (data_ != nullptr && release_ != nullptr) {
+      release_(data_);
+    }
+    data_ = nullptr;
+  }
+
+ private:
+  const byte_type* data_ = nullptr;
+  std::size_t length_ = 0;
+  size_type size_ = 0;
+  release_func release_ = nullptr;
+};